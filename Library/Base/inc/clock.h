@@ -0,0 +1,71 @@
+/**
+  \file clock.h
+
+  \author G. Icking-Konert
+  \date 2026-10-17
+  \version 0.1
+
+  \brief declaration of clock functions & macros
+
+  declaration of functions and macros to query the master clock f_MASTER,
+  which is used e.g. for UART baudrate generation.
+  Optional functionality via #define:
+    - F_MASTER:   constant master clock [Hz]. Allows compile-time calculation of e.g. UART baudrate.
+                  If not defined, f_MASTER is determined at runtime from the CLK registers
+    - HSE_VALUE:  frequency of external oscillator [Hz] (default 16MHz)
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _CLOCK_H_
+#define _CLOCK_H_
+
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include <stdint.h>
+#include "stm8as.h"
+#include "config.h"
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL MACROS
+-----------------------------------------------------------------------------*/
+
+// clock sources
+#define HSI_VALUE     16000000L     ///< frequency of internal high speed oscillator [Hz]
+#define LSI_VALUE     128000L       ///< frequency of internal low speed oscillator [Hz]
+#if !defined(HSE_VALUE)
+  #define HSE_VALUE   16000000L     ///< frequency of external oscillator [Hz]. Can be overwritten in config.h
+#endif
+
+// clock master identifiers in CLK_CMSR / CLK_SWR
+#define CLK_SOURCE_HSI    0xE1      ///< f_MASTER from HSI
+#define CLK_SOURCE_LSI    0xD2      ///< f_MASTER from LSI
+#define CLK_SOURCE_HSE    0xB4      ///< f_MASTER from HSE
+
+// constant master clock -> no register access required
+#if defined(F_MASTER)
+  #define CLK_getMaster()   ((uint32_t) (F_MASTER))   ///< get master clock f_MASTER [Hz]
+#endif
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+// master clock is not constant -> get from CLK registers
+#if !defined(F_MASTER)
+
+  /// get master clock f_MASTER [Hz] from clock settings
+  uint32_t CLK_getMaster(void);
+
+#endif
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif  // _CLOCK_H_
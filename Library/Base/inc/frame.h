@@ -0,0 +1,102 @@
+/**
+  \file frame.h
+
+  \author G. Icking-Konert
+  \date 2026-10-17
+  \version 0.1
+
+  \brief declaration of framed packet protocol
+
+  declaration of functions for framed packet transfer via a byte stream, e.g. UART.
+  Frames are SLIP encoded (RFC 1055) and protected by a CRC16-CCITT (poly 0x1021,
+  start 0xFFFF, MSB first). Format on wire: END, payload, CRC16, END.
+  Receive is done by an incremental state machine, which can be fed directly
+  from a receive ISR (e.g. via UART1_attachReceive(frame_receiveByte)).
+  Complete frames with valid CRC are passed to a callback function.
+  Optional functionality via #define:
+    - FRAME_BUFFER_SIZE: max. payload size [B] (default 64, max. 253)
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _FRAME_H_
+#define _FRAME_H_
+
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include <stdint.h>
+#include "stm8as.h"
+#include "config.h"
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL MACROS
+-----------------------------------------------------------------------------*/
+
+// default max. payload size [B]
+#if !defined(FRAME_BUFFER_SIZE)
+  #define FRAME_BUFFER_SIZE   64
+#endif
+#if (FRAME_BUFFER_SIZE < 1) || (FRAME_BUFFER_SIZE > 253)
+  #error FRAME_BUFFER_SIZE must be in range 1..253
+#endif
+
+// SLIP special characters
+#define SLIP_END        0xC0      ///< frame delimiter
+#define SLIP_ESC        0xDB      ///< escape character
+#define SLIP_ESC_END    0xDC      ///< escaped frame delimiter
+#define SLIP_ESC_ESC    0xDD      ///< escaped escape character
+
+// access receive statistics
+#define frame_numOk()         g_frameStats.numOk                  ///< number of frames received with valid CRC
+#define frame_errCrc()        g_frameStats.errCrc                 ///< number of frames with CRC error or too short
+#define frame_errOverflow()   g_frameStats.errOverflow            ///< number of frames exceeding FRAME_BUFFER_SIZE
+#define frame_errEscape()     g_frameStats.errEscape              ///< number of frames with illegal escape sequence
+#define frame_clearStats()    {g_frameStats.numOk = 0; g_frameStats.errCrc = 0; g_frameStats.errOverflow = 0; g_frameStats.errEscape = 0;}  ///< reset statistics
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL TYPEDEFS
+-----------------------------------------------------------------------------*/
+
+/** frame receive statistics (frame_stats_t) */
+typedef struct {
+  volatile uint16_t   numOk;          ///< frames received with valid CRC
+  volatile uint16_t   errCrc;         ///< frames with CRC error or too short
+  volatile uint16_t   errOverflow;    ///< frames exceeding FRAME_BUFFER_SIZE
+  volatile uint16_t   errEscape;      ///< frames with illegal escape sequence
+} frame_stats_t;
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL VARIABLES
+-----------------------------------------------------------------------------*/
+
+/// receive statistics. Defined in frame.c
+extern frame_stats_t  g_frameStats;
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/// init frame protocol with byte send function and frame receive callback
+void      frame_begin(void (*pSend)(uint8_t), void (*pReceive)(uint8_t, uint8_t*));
+
+/// send SLIP encoded frame with CRC16
+void      frame_send(uint8_t num, uint8_t *buf);
+
+/// receive state machine. Feed with each received byte, e.g. from ISR
+void      frame_receiveByte(uint8_t data);
+
+/// update CRC16-CCITT with one byte (table-free)
+uint16_t  frame_crc16(uint16_t crc, uint8_t data);
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif  // _FRAME_H_
@@ -9,6 +9,9 @@
    
   declaration of getchar() function required for stdio.h
   functions, e.g. gets(). 
+  Additionally a non-blocking line assembler with echo and
+  backspace support (gets_begin(), gets_feed()), which can be 
+  fed from the main loop or a receive ISR.
 */
 
 /*-----------------------------------------------------------------------------
@@ -30,6 +33,9 @@
 
 /// detach receive function 
 #define getcharDetach()  getcharAttach(getchar_Default)
+
+/// check if line is complete. Then read buffer and call gets_release()
+#define gets_ready()     (g_gets_flagReady)
   
 
 /*-----------------------------------------------------------------------------
@@ -42,6 +48,23 @@ uint8_t getchar_Default(void);
 /// set getchar() receive function
 void getcharAttach(uint8_t (*pFct)(void));
 
+/// init non-blocking line assembler
+void gets_begin(char *buf, uint8_t size, void (*pEcho)(uint8_t));
+
+/// pass received character to line assembler
+void gets_feed(uint8_t c);
+
+/// release line buffer for next line
+void gets_release(void);
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL VARIABLES
+-----------------------------------------------------------------------------*/
+
+/// line assembler: complete line in buffer. Defined in getchar.c
+extern volatile uint8_t   g_gets_flagReady;
+
 /*-----------------------------------------------------------------------------
     END OF MODULE
 -----------------------------------------------------------------------------*/
@@ -9,6 +9,10 @@
    
   declaration of functions for I2C bus communication
   For I2C bus, see http://en.wikipedia.org/wiki/I2C
+  Optional functionality via #define:
+    - USE_I2C_QUEUE: interrupt driven master transactions via queue (requires USE_I2C_ISR and USE_TIM4_UPD_ISR)
+    - I2C_QUEUE_TIMEOUT: max. duration [ms] of a queued transaction before it is aborted (default 50)
+    - USE_I2C_SLAVE: interrupt driven slave with register map, see i2c_slave.h (requires USE_I2C_ISR)
 */
 
 /*-----------------------------------------------------------------------------
@@ -29,14 +33,119 @@
 /// check I2C busy flag
 #define I2C_BUSY  (I2C.SR3.reg.BUSY)
 
+// I2C bus speeds [Hz] for i2c_begin()
+#define I2C_SPEED_STANDARD  100000L   ///< standard mode (max. speed)
+#define I2C_SPEED_FAST      400000L   ///< fast mode (max. speed)
+
+// transaction queue requires I2C interrupt, which is then handled in i2c.c
+#if defined(USE_I2C_QUEUE) && !defined(USE_I2C_ISR)
+  #error USE_I2C_QUEUE requires USE_I2C_ISR in config.h
+#endif
+#if defined(USE_I2C_QUEUE) && !defined(USE_TIM4_UPD_ISR)
+  #error USE_I2C_QUEUE requires USE_TIM4_UPD_ISR in config.h for the queue watchdog
+#endif
+#if defined(USE_I2C_QUEUE) && defined(USE_I2C_SLAVE)
+  #error USE_I2C_QUEUE and USE_I2C_SLAVE can't be combined, both use the I2C ISR
+#endif
+
+// I2C transaction status
+#define I2C_OK              0       ///< transaction successful
+#define I2C_ERR_TIMEOUT     1       ///< timeout (blocking functions only)
+#define I2C_ERR_NACK_ADDR   2       ///< slave did not acknowledge address
+#define I2C_ERR_NACK_DATA   3       ///< slave did not acknowledge data byte
+#define I2C_ERR_ARLO        4       ///< arbitration lost
+#define I2C_ERR_BUS         5       ///< bus error (misplaced start/stop) or overrun
+#define I2C_ERR_STUCK       6       ///< SDA or SCL held low by slave, bus recovery failed
+#define I2C_ERR_ABORT       7       ///< queued transaction aborted by i2c_begin() or bus recovery
+#define I2C_NUM_ERR         7       ///< number of error codes
+#define I2C_PENDING         0xFF    ///< transaction queued or in progress
+
+// access error statistics
+#define i2c_errCount(code)  g_i2c_stats.err[(code)-1]     ///< number of errors with code I2C_ERR_xxx
+#define i2c_numRecover()    g_i2c_stats.numRecover        ///< number of bus recoveries
+
+/// check presence cache if slave may be present (see i2c_scan()). Slaves not yet probed are assumed present
+#define i2c_isPresent(addr) (g_i2c_present[((addr) >> 3) & 0x0F] & (uint8_t) (1 << ((addr) & 0x07)))
+
+// I2C transaction flags
+#define I2C_REPSTART        0x01    ///< no stop after transaction, next queued transaction starts with repeated start
+
+#if defined(USE_I2C_QUEUE)
+
+  // max. duration [ms] of a queued transaction before it is aborted by the watchdog
+  #if !defined(I2C_QUEUE_TIMEOUT)
+    #define I2C_QUEUE_TIMEOUT   50
+  #endif
+
+  /// check if transaction queue is empty. Also checks queue watchdog
+  #define i2c_isIdleQueue()     (i2c_checkQueue(), (g_i2c_pQueue == NULL))
+
+#endif // USE_I2C_QUEUE
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL TYPEDEFS
+-----------------------------------------------------------------------------*/
+
+/** I2C error statistics (i2c_stats_t). Counters saturate at 0xFFFF */
+typedef struct {
+  volatile uint16_t   err[I2C_NUM_ERR]; ///< number of errors per code, index is I2C_ERR_xxx-1
+  volatile uint16_t   numRecover;       ///< number of bus recoveries
+} i2c_stats_t;
+
+#if defined(USE_I2C_QUEUE)
+
+  /** I2C master transaction (i2c_trans_t). Write numTx bytes, then read numRx bytes after repeated start.
+      Is linked into the queue, i.e. must stay valid and unchanged until status != I2C_PENDING */
+  typedef struct i2c_trans_s {
+    uint8_t             addr;       ///< 7b address [6:0] of I2C slave
+    uint8_t             flags;      ///< transaction flags, e.g. I2C_REPSTART
+    uint8_t             numTx;      ///< number of bytes to write
+    uint8_t             *bufTx;     ///< write buffer
+    uint8_t             numRx;      ///< number of bytes to read (after write)
+    uint8_t             *bufRx;     ///< read buffer
+    void                (*pCallback)(struct i2c_trans_s *pTrans);   ///< called from ISR on completion. NULL for none
+    volatile uint8_t    status;     ///< I2C_PENDING, I2C_OK or I2C_ERR_xxx
+    struct i2c_trans_s  *pNext;     ///< next queued transaction (used internally)
+  } i2c_trans_t;
+
+#endif // USE_I2C_QUEUE
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL VARIABLES
+-----------------------------------------------------------------------------*/
+
+/// error statistics. Defined in i2c.c
+extern i2c_stats_t  g_i2c_stats;
+
+/// presence cache, 1 bit per 7b address. Defined in i2c.c
+extern uint8_t      g_i2c_present[16];
+
+#if defined(USE_I2C_QUEUE)
+
+  /// active transaction and head of queue (NULL=idle). Defined in i2c.c
+  extern i2c_trans_t * volatile   g_i2c_pQueue;
+
+#endif // USE_I2C_QUEUE
+
 
 /*-----------------------------------------------------------------------------
     DECLARATION OF GLOBAL FUNCTIONS
 -----------------------------------------------------------------------------*/
 
-/// configure I2C bus as master in standard mode
+/// configure I2C bus as master with given SCL frequency
+uint32_t  i2c_begin(uint32_t speed);
+
+/// (re-)configure I2C bus as master with speed of last i2c_begin() (default 100kHz)
 void      i2c_init(void);
 
+/// recover stuck bus via SCL clocks and stop condition, then re-init
+uint8_t   i2c_recover(void);
+
+/// reset error statistics
+void      i2c_clearStats(void);
+
 /// wait until bus is free
 uint8_t   i2c_waitFree(void);
 
@@ -52,6 +161,25 @@ uint8_t   i2c_send(uint8_t addr, uint8_t numTx, uint8_t *Tx);
 /// request data via I2C as master
 uint8_t   i2c_request(uint8_t addr, uint8_t numRx, uint8_t *Rx);
 
+/// write, then read data via I2C with repeated start. Generates start & stop
+uint8_t   i2c_writeRead(uint8_t addr, uint8_t numTx, uint8_t *bufTx, uint8_t numRx, uint8_t *bufRx);
+
+/// check if slave is present and update presence cache
+uint8_t   i2c_probe(uint8_t addr);
+
+/// probe all 7b addresses and fill presence cache. Return number of slaves
+uint8_t   i2c_scan(void);
+
+#if defined(USE_I2C_QUEUE)
+
+  /// add transaction to queue. Is processed in background by I2C ISR
+  uint8_t   i2c_submit(i2c_trans_t *pTrans);
+
+  /// queue watchdog: abort active transaction after I2C_QUEUE_TIMEOUT. Call when polling status
+  uint8_t   i2c_checkQueue(void);
+
+#endif // USE_I2C_QUEUE
+
 
 /*-----------------------------------------------------------------------------
     END OF MODULE DEFINITION FOR MULTIPLE INLUSION
@@ -0,0 +1,71 @@
+/**
+  \file i2c_slave.h
+
+  \author G. Icking-Konert
+  \date 2026-10-17
+  \version 0.1
+
+  \brief declaration of I2C slave with register map
+
+  declaration of interrupt driven I2C slave. The master accesses a RAM register
+  map like common I2C sensors: a write starts with the register address, followed
+  by data bytes, a read returns data from the current register address. The
+  register address auto-increments after each byte. Reads beyond the map return
+  0xFF, writes beyond the map are ignored.
+  Callbacks are called from ISR:
+    - pRead(reg) on address match for read, e.g. to update map before it is sent
+    - pWrite(reg, num) after master has written num bytes starting at reg
+  Response latency: SCL is stretched until the ISR has served a byte, i.e. the
+  master never sees wrong data. Worst case stretch = longest ISR with same or higher
+  priority + I2C ISR incl. callback. Keep callbacks short.
+  Requires in config.h:
+    - USE_I2C_ISR and USE_I2C_SLAVE. Can't be combined with USE_I2C_QUEUE (see i2c.h), which also uses the I2C ISR
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _I2C_SLAVE_H_
+#define _I2C_SLAVE_H_
+
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include <stdint.h>
+#include "stm8as.h"
+#include "config.h"
+#include "i2c.h"
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL MACROS
+-----------------------------------------------------------------------------*/
+
+// slave mode requires I2C interrupt, which is then handled in i2c_slave.c
+#if !defined(USE_I2C_SLAVE) || !defined(USE_I2C_ISR)
+  #error i2c_slave.h requires USE_I2C_SLAVE and USE_I2C_ISR in config.h
+#endif
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/// configure I2C as slave with own address and register map
+void      i2c_slave_begin(uint8_t addr, uint8_t size, uint8_t *regs, void (*pWrite)(uint8_t, uint8_t), void (*pRead)(uint8_t));
+
+/// disable I2C slave
+void      i2c_slave_end(void);
+
+/// block master access, e.g. for consistent update of multi-byte registers. SCL is stretched meanwhile
+void      i2c_slave_lock(void);
+
+/// allow master access again
+void      i2c_slave_unlock(void);
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif  // _I2C_SLAVE_H_
@@ -223,7 +223,7 @@
 uint8_t log2(uint32_t arg);
 
 #if defined(USE_FTOA)
-  /// convert float to ascii string for printf() output. Adds ~3.3kB -> require USE_FTOA
+  /// convert float to ascii string for printf() output. Requires float library -> require USE_FTOA
   char *floatToString(char *buf, float f, uint8_t digits);
 #endif
 
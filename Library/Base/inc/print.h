@@ -0,0 +1,58 @@
+/**
+  \file print.h
+
+  \author G. Icking-Konert
+  \date 2026-10-17
+  \version 0.1
+
+  \brief declaration of lightweight formatted output
+
+  declaration of a small, integer-only replacement for printf(). Output is
+  sent via putchar(), i.e. to the function set by putcharAttach() or
+  putcharAttachBuffered(). Supported conversions:
+    - %c, %s, %%
+    - %d, %u, %x, %X: 16-bit integer. With prefix 'l' (e.g. %ld) 32-bit integer
+    - %q: signed fixed point with N decimals (default 2), e.g. print("%.3q", 1234) -> "1.234"
+    - optional width and zero padding for numbers, e.g. %5d or %04x. Output is right aligned
+  Budget: <=1.5kB flash and <=150 cycles/char at 16MHz, see Print_Benchmark example
+  Optional functionality via #define:
+    - PRINT_Q_DEFAULT: default number of decimals for %q (default 2)
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _PRINT_H_
+#define _PRINT_H_
+
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include <stdint.h>
+#include "stm8as.h"
+#include "config.h"
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL MACROS
+-----------------------------------------------------------------------------*/
+
+// default number of decimals for %q
+#if !defined(PRINT_Q_DEFAULT)
+  #define PRINT_Q_DEFAULT   2
+#endif
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/// formatted output via putchar(). Integer only, see print.h
+void print(const char *fmt, ...);
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif  // _PRINT_H_
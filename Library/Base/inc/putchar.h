@@ -9,6 +9,9 @@
    
   declaration of putchar() function required for stdio.h
   functions, e.g. printf(). 
+  Output is either sent directly via putcharAttach(), or queued
+  without blocking via putcharAttachBuffered(), e.g. to the
+  send buffer of UART1 (see USE_UART1_BUFFER)
 */
 
 /*-----------------------------------------------------------------------------
@@ -30,6 +33,22 @@
 
 /// detach send function
 #define putcharDetach()  putcharAttach(putchar_Default)
+
+// policy for full buffer in buffered mode, see putcharAttachBuffered()
+#define PUTCHAR_DROP     0    ///< discard character
+#define PUTCHAR_BLOCK    1    ///< wait until buffer has space. Don't use in ISRs!
+#define PUTCHAR_COUNT    2    ///< discard character and count in putcharOverflow()
+
+#define putcharOverflow()       g_putchar_overflow        ///< number of characters discarded with PUTCHAR_COUNT
+#define putcharClearOverflow()  g_putchar_overflow = 0    ///< reset overflow counter
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL VARIABLES
+-----------------------------------------------------------------------------*/
+
+/// number of characters discarded with PUTCHAR_COUNT. Defined in putchar.c
+extern volatile uint16_t  g_putchar_overflow;
   
 
 /*-----------------------------------------------------------------------------
@@ -42,6 +61,12 @@ void putchar_Default(uint8_t data);
 /// set putchar() send function
 void putcharAttach(void (*pFct)(uint8_t));
 
+/// set non-blocking putchar() send and flush functions with policy for full buffer
+void putcharAttachBuffered(uint8_t (*pFct)(uint8_t), void (*pFlush)(void), uint8_t policy);
+
+/// wait until buffered output is sent
+void putchar_flush(void);
+
 /*-----------------------------------------------------------------------------
     END OF MODULE
 -----------------------------------------------------------------------------*/
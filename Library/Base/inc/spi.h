@@ -9,6 +9,8 @@
    
   declaration of functions for SPI communication
   For SPI bus, see https://en.wikipedia.org/wiki/Serial_Peripheral_Interface_Bus
+  Optional functionality via #define:
+    - USE_SPI_QUEUE: interrupt driven master transfers via queue (requires USE_SPI_ISR)
 */
 
 /*-----------------------------------------------------------------------------
@@ -35,6 +37,72 @@
 #define  SPI_MODE2     2     ///< clock phase & polarity, see https://www.arduino.cc/en/Reference/SPI
 #define  SPI_MODE3     3     ///< clock phase & polarity, see https://www.arduino.cc/en/Reference/SPI
 
+/// receive data via SPI w/o CSN control by sending 0xFF (4-wire, master mode). Return 1 on overrun
+#define spi_read(num, buf)     spi_transfer(num, NULL, buf)
+
+// transfer queue requires SPI interrupt, which is then handled in spi.c
+#if defined(USE_SPI_QUEUE) && !defined(USE_SPI_ISR)
+  #error USE_SPI_QUEUE requires USE_SPI_ISR in config.h
+#endif
+
+#if defined(USE_SPI_QUEUE)
+
+  // SPI transfer status
+  #define  SPI_OK        0     ///< transfer successful
+  #define  SPI_ERR_OVR   1     ///< receive overrun
+  #define  SPI_PENDING   0xFF  ///< transfer queued or in progress
+
+  // SPI transfer flags
+  #define  SPI_KEEP_CS   0x01  ///< keep CSN low after transfer, e.g. for command followed by data transfer
+
+  /// check if transfer queue is empty
+  #define spi_isIdleQueue()    (g_spi_pQueue == NULL)
+
+#endif // USE_SPI_QUEUE
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL TYPEDEFS
+-----------------------------------------------------------------------------*/
+
+/** SPI device profile (spi_profile_t) for fast switching between slaves, see spi_select() */
+typedef struct {
+  uint8_t             CR1;        ///< SPI_CR1 value (mode, prescaler, bit order)
+  uint8_t             CR2;        ///< SPI_CR2 value (3-/4-wire)
+  PORT_t              *pPortCSN;  ///< port of CSN, e.g. &PORT_A. NULL for no CSN control
+  uint8_t             pinCSN;     ///< CSN pin number (0..7)
+} spi_profile_t;
+
+#if defined(USE_SPI_QUEUE)
+
+  /** SPI master transfer (spi_trans_t) in 4-wire full-duplex mode. Is linked
+      into the queue, i.e. must stay valid and unchanged until status != SPI_PENDING */
+  typedef struct spi_trans_s {
+    PORT_t              *pPortCSN;  ///< port of CSN, e.g. &PORT_A. NULL for no CSN control
+    uint8_t             pinCSN;     ///< CSN pin number (0..7)
+    uint8_t             flags;      ///< transfer flags, e.g. SPI_KEEP_CS
+    uint16_t            num;        ///< number of bytes to transfer
+    uint8_t             *bufTx;     ///< send buffer. NULL to send 0xFF
+    uint8_t             *bufRx;     ///< receive buffer. NULL to discard
+    void                (*pCallback)(struct spi_trans_s *pTrans);   ///< called from ISR on completion. NULL for none
+    volatile uint8_t    status;     ///< SPI_PENDING, SPI_OK or SPI_ERR_xxx
+    struct spi_trans_s  *pNext;     ///< next queued transfer (used internally)
+  } spi_trans_t;
+
+#endif // USE_SPI_QUEUE
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL VARIABLES
+-----------------------------------------------------------------------------*/
+
+#if defined(USE_SPI_QUEUE)
+
+  /// active transfer and head of queue (NULL=idle). Defined in spi.c
+  extern spi_trans_t * volatile   g_spi_pQueue;
+
+#endif // USE_SPI_QUEUE
+
 
 /*-----------------------------------------------------------------------------
     DECLARATION OF GLOBAL FUNCTIONS
@@ -49,9 +117,31 @@ void    spi_save_config(uint8_t N);
 /// restore SPI configuration N
 void    spi_restore_config(uint8_t N);
 
+/// set up SPI device profile (settings + CSN pin)
+void    spi_initProfile(spi_profile_t *pProfile, uint8_t type, uint8_t pre, uint8_t order, uint8_t mode, PORT_t *pPortCSN, uint8_t pinCSN);
+
+/// switch SPI to device profile and select slave
+void    spi_select(spi_profile_t *pProfile);
+
+/// de-select slave selected by spi_select()
+void    spi_deselect(void);
+
 /// send and receive data via SPI (master mode)
 void    spi_send_receive(PORT_t *pPortCSN, uint8_t pinCSN, uint8_t numMOSI, uint8_t *MOSI, uint8_t numMISO, uint8_t *MISO);
 
+/// send data via SPI w/o CSN control (4-wire, master mode)
+void    spi_write(uint16_t num, uint8_t *buf);
+
+/// exchange data via SPI w/o CSN control (4-wire, master mode). Return 1 on overrun
+uint8_t spi_transfer(uint16_t num, uint8_t *bufTx, uint8_t *bufRx);
+
+#if defined(USE_SPI_QUEUE)
+
+  /// add transfer to queue. Is processed in background by SPI ISR
+  uint8_t spi_submit(spi_trans_t *pTrans);
+
+#endif // USE_SPI_QUEUE
+
 
 /*-----------------------------------------------------------------------------
     END OF MODULE DEFINITION FOR MULTIPLE INLUSION
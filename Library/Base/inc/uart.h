@@ -0,0 +1,289 @@
+/**
+  \file uart.h
+
+  \author G. Icking-Konert
+  \date 2026-10-17
+  \version 0.1
+
+  \brief declaration of generic UART functions & macros
+
+  declaration of generic UART functions used by all UART instances (UART1..4).
+  Each instance is described by a descriptor (see uart1.c..uart4.c), which
+  selects the registers and optional ring buffers. Polling and buffered mode are
+  implemented here once. The per instance API UARTn_xyz() is generated via the
+  UART_DECLARE_xxx() / UART_DEFINE_xxx() macros below. Don't use directly,
+  instead include uart1.h..uart4.h.
+  Baudrate is derived from master clock f_MASTER, see clock.h. If F_MASTER is
+  a constant, UARTn_beginConst() calculates the baudrate divider at compile time.
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _UART_H_
+#define _UART_H_
+
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "stm8as.h"
+#include "config.h"
+#include "clock.h"
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL MACROS
+-----------------------------------------------------------------------------*/
+
+/// buffered mode is used by at least one UART -> compile buffer handling
+#if defined(USE_UART1_BUFFER) || defined(USE_UART2_BUFFER) || defined(USE_UART3_BUFFER) || defined(USE_UART4_BUFFER)
+  #define UART_USE_BUFFER
+#endif
+
+/// buffer indices are free running 8-bit counters -> size must be 2^N and <=128
+#define UART_BUFFER_SIZE_OK(size)   (((size) >= 2) && ((size) <= 128) && (((size) & ((size)-1)) == 0))
+
+/// valid range of baudrate divider (BR = f_MASTER / UART_DIV)
+#define UART_DIV_MIN      16
+#define UART_DIV_MAX      0xFFFF
+
+/// baudrate divider for master clock f [Hz] and baudrate BR [Baud], rounded to nearest
+#define UART_DIV(f,BR)    (((f) + (BR)/2) / (BR))
+
+/** baudrate error [0.01%] for master clock f [Hz] and baudrate BR [Baud]. Positive if actual baudrate
+ is too high. No casts, thus also usable in #if, e.g. #if UART_ERROR(F_MASTER,1000000L) != 0. Requires
+ signed constants, e.g. 16000000L */
+#define UART_ERROR(f,BR)  (((f) - UART_DIV(f,BR)*(BR)) / ((UART_DIV(f,BR)*(BR) + 5000L) / 10000L))
+
+// with constant master clock calculate baudrate divider at compile time. Returns baudrate error [0.01%]
+#if defined(F_MASTER)
+  #define UART_beginConst(pDesc,BR)   (UART_beginDiv(pDesc, (uint16_t) UART_DIV(F_MASTER, BR)), (int16_t) UART_ERROR(F_MASTER, BR))
+#endif
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL TYPEDEFS
+-----------------------------------------------------------------------------*/
+
+/// UART registers used here. Layout of SR..CR3 is identical for UART1..4, see stm8as.h
+typedef UART1_t   UART_t;
+
+
+/** ring buffer for interrupt driven mode (UART_buffer_t) */
+typedef struct {
+  uint8_t             *buf;       ///< buffer memory or NULL for polling mode
+  uint8_t             mask;       ///< buffer size - 1
+  volatile uint8_t    head;       ///< index of next free byte. Only written by producer
+  volatile uint8_t    tail;       ///< index of next byte to consume. Only written by consumer
+  volatile uint16_t   overflow;   ///< number of bytes lost or rejected due to full buffer
+} UART_buffer_t;
+
+
+/** UART instance descriptor (UART_desc_t) */
+typedef struct {
+  volatile UART_t     *pReg;      ///< pointer to UART registers
+  UART_buffer_t       tx;         ///< send buffer. Emptied by TXE ISR
+  UART_buffer_t       rx;         ///< receive buffer. Filled by RXF ISR
+  #if defined(UART_USE_BUFFER)
+    uint8_t * volatile pAsync;    ///< next byte of zero-copy send buffer. NULL if idle
+    volatile uint16_t numAsync;   ///< remaining bytes of zero-copy send buffer
+    void              (*pAsyncDone)(void);  ///< called when zero-copy send is complete. NULL for none
+    void              (*pRxFct)(uint8_t);   ///< called from RXF ISR with received byte instead of buffering. NULL for none
+    void              (*pIdleFct)(void);    ///< called from RXF ISR at end of burst (idle line). NULL for none
+    volatile uint8_t  idleHead;   ///< rx.head at last idle line, i.e. end of last completed burst
+  #endif
+} UART_desc_t;
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/// init UART with baudrate [Baud] derived from f_MASTER. Returns baudrate error [0.01%]
+int16_t   UART_begin(UART_desc_t *pDesc, uint32_t BR);
+
+/// init UART with precalculated baudrate divider
+void      UART_beginDiv(UART_desc_t *pDesc, uint16_t div);
+
+/// disable UART sender & receiver
+void      UART_end(UART_desc_t *pDesc);
+
+/// number of received bytes not yet read
+uint8_t   UART_available(UART_desc_t *pDesc);
+
+/// send byte via UART
+void      UART_write(UART_desc_t *pDesc, uint8_t data);
+
+/// send array of bytes via UART
+void      UART_writeBytes(UART_desc_t *pDesc, uint16_t num, uint8_t *buf);
+
+/// receive byte via UART. Blocking
+uint8_t   UART_read(UART_desc_t *pDesc);
+
+
+// for interrupt driven, buffered communication
+#if defined(UART_USE_BUFFER)
+
+  /// number of free bytes in send buffer
+  uint8_t   UART_availableForWrite(UART_desc_t *pDesc);
+
+  /// queue byte if send buffer has space. Never blocks
+  uint8_t   UART_tryWrite(UART_desc_t *pDesc, uint8_t data);
+
+  /// queue as many bytes as fit into send buffer. Never blocks
+  uint16_t  UART_writeNonBlocking(UART_desc_t *pDesc, uint16_t num, uint8_t *buf);
+
+  /// wait until all queued bytes are sent
+  void      UART_flush(UART_desc_t *pDesc);
+
+  /// send buffer without copy in background. Callback on completion
+  uint8_t   UART_writeAsync(UART_desc_t *pDesc, uint16_t num, uint8_t *buf, void (*pFct)(void));
+
+  /// set function called from RXF ISR for each received byte. NULL to buffer bytes
+  void      UART_attachReceive(UART_desc_t *pDesc, void (*pFct)(uint8_t));
+
+  /// enable end of burst detection via idle line. Optional callback
+  void      UART_enableIdle(UART_desc_t *pDesc, void (*pFct)(void));
+
+  /// number of received bytes belonging to completed bursts
+  uint8_t   UART_availableBurst(UART_desc_t *pDesc);
+
+  /// copy completed burst from receive buffer. Never blocks
+  uint8_t   UART_readBurst(UART_desc_t *pDesc, uint8_t *buf, uint8_t max);
+
+  /// handler for TXE interrupt. Called from ISR of respective UART
+  void      UART_TXE_handler(UART_desc_t *pDesc);
+
+  /// handler for RXF interrupt. Called from ISR of respective UART
+  void      UART_RXF_handler(UART_desc_t *pDesc);
+
+#endif // UART_USE_BUFFER
+
+
+/*-----------------------------------------------------------------------------
+    GENERATION OF UART INSTANCES (used by uart1.h/.c..uart4.h/.c)
+-----------------------------------------------------------------------------*/
+
+/**
+  \def UART_DECLARE_COMMON(n)
+
+  \brief declare descriptor and mode independent inline functions of UARTn
+
+  declare descriptor g_UARTn (defined in uartn.c) and the inline functions
+    - int16_t UARTn_begin(uint32_t BR): init with baudrate [Baud], see UART_begin()
+    - void UARTn_end(void): disable sender & receiver
+    - void UARTn_writeBytes(uint16_t num, uint8_t *buf): send array of bytes
+    - void UARTn_enable_send_interrupt(void), UARTn_disable_send_interrupt(void): TXE interrupt
+    - void UARTn_enable_receive_interrupt(void), UARTn_disable_receive_interrupt(void): RXF interrupt
+  Not used directly, see UART_DECLARE_POLLING() and UART_DECLARE_BUFFERED()
+*/
+#define UART_DECLARE_COMMON(n) \
+  extern UART_desc_t  g_UART##n; \
+  INLINE int16_t UART##n##_begin(uint32_t BR) { return(UART_begin(&g_UART##n, BR)); } \
+  INLINE void UART##n##_end(void) { UART_end(&g_UART##n); } \
+  INLINE void UART##n##_writeBytes(uint16_t num, uint8_t *buf) { UART_writeBytes(&g_UART##n, num, buf); } \
+  INLINE void UART##n##_enable_send_interrupt(void) { UART##n.CR2.reg.TIEN = 1; } \
+  INLINE void UART##n##_disable_send_interrupt(void) { UART##n.CR2.reg.TIEN = 0; } \
+  INLINE void UART##n##_enable_receive_interrupt(void) { UART##n.CR2.reg.RIEN = 1; } \
+  INLINE void UART##n##_disable_receive_interrupt(void) { UART##n.CR2.reg.RIEN = 0; }
+
+
+/**
+  \def UART_DECLARE_POLLING(n)
+
+  \brief declare UARTn functions for polling mode
+
+  declare UART_DECLARE_COMMON(n) plus the inline functions
+    - uint8_t UARTn_available(void): 1=byte received, 0=Rx register empty
+    - void UARTn_write(uint8_t data): wait until Tx register is empty, then send byte
+    - uint8_t UARTn_read(void): wait until byte received and return it
+  These access the UARTn registers directly, i.e. don't call uart.c
+*/
+#define UART_DECLARE_POLLING(n) \
+  UART_DECLARE_COMMON(n) \
+  INLINE uint8_t UART##n##_available(void) { return(UART##n.SR.reg.RXNE); } \
+  INLINE void UART##n##_write(uint8_t data) { while (!(UART##n.SR.reg.TXE)); UART##n.DR.byte = data; } \
+  INLINE uint8_t UART##n##_read(void) { while (!(UART##n.SR.reg.RXNE)); return(UART##n.DR.byte); }
+
+
+/**
+  \def UART_DECLARE_BUFFERED(n)
+
+  \brief declare UARTn functions for interrupt driven, buffered mode
+
+  declare UART_DECLARE_COMMON(n) plus inline wrappers of the respective
+  generic functions in uart.c, i.e. UARTn_xyz(...) calls UART_xyz(&g_UARTn, ...):
+    - UARTn_available(), UARTn_write(), UARTn_read()
+    - UARTn_availableForWrite(), UARTn_tryWrite(), UARTn_writeNonBlocking(), UARTn_flush(), UARTn_writeAsync()
+    - UARTn_attachReceive(), UARTn_enableIdle(), UARTn_availableBurst(), UARTn_readBurst()
+  and the helpers
+    - uint16_t UARTn_overflowTx(void): number of bytes rejected by UARTn_writeNonBlocking()
+    - uint16_t UARTn_overflowRx(void): number of received bytes lost due to full buffer
+    - void UARTn_clearOverflow(void): reset both overflow counters
+    - uint8_t UARTn_isBusyAsync(void): zero-copy transfer via UARTn_writeAsync() active
+    - void UARTn_detachReceive(void): store received bytes in receive buffer again
+    - void UARTn_disableIdle(void): disable end of burst detection
+*/
+#define UART_DECLARE_BUFFERED(n) \
+  UART_DECLARE_COMMON(n) \
+  INLINE uint8_t UART##n##_available(void) { return(UART_available(&g_UART##n)); } \
+  INLINE void UART##n##_write(uint8_t data) { UART_write(&g_UART##n, data); } \
+  INLINE uint8_t UART##n##_read(void) { return(UART_read(&g_UART##n)); } \
+  INLINE uint8_t UART##n##_availableForWrite(void) { return(UART_availableForWrite(&g_UART##n)); } \
+  INLINE uint8_t UART##n##_tryWrite(uint8_t data) { return(UART_tryWrite(&g_UART##n, data)); } \
+  INLINE uint16_t UART##n##_writeNonBlocking(uint16_t num, uint8_t *buf) { return(UART_writeNonBlocking(&g_UART##n, num, buf)); } \
+  INLINE void UART##n##_flush(void) { UART_flush(&g_UART##n); } \
+  INLINE uint8_t UART##n##_writeAsync(uint16_t num, uint8_t *buf, void (*pFct)(void)) { return(UART_writeAsync(&g_UART##n, num, buf, pFct)); } \
+  INLINE uint16_t UART##n##_overflowTx(void) { return(g_UART##n.tx.overflow); } \
+  INLINE uint16_t UART##n##_overflowRx(void) { return(g_UART##n.rx.overflow); } \
+  INLINE void UART##n##_clearOverflow(void) { g_UART##n.tx.overflow = 0; g_UART##n.rx.overflow = 0; } \
+  INLINE uint8_t UART##n##_isBusyAsync(void) { return(g_UART##n.pAsync != NULL); } \
+  INLINE void UART##n##_attachReceive(void (*pFct)(uint8_t)) { UART_attachReceive(&g_UART##n, pFct); } \
+  INLINE void UART##n##_detachReceive(void) { UART_attachReceive(&g_UART##n, NULL); } \
+  INLINE void UART##n##_enableIdle(void (*pFct)(void)) { UART_enableIdle(&g_UART##n, pFct); } \
+  INLINE void UART##n##_disableIdle(void) { UART##n.CR2.reg.ILIEN = 0; } \
+  INLINE uint8_t UART##n##_availableBurst(void) { return(UART_availableBurst(&g_UART##n)); } \
+  INLINE uint8_t UART##n##_readBurst(uint8_t *buf, uint8_t max) { return(UART_readBurst(&g_UART##n, buf, max)); }
+
+
+/**
+  \def UART_DEFINE_POLLING(n)
+
+  \brief define descriptor g_UARTn for polling mode (no buffers)
+*/
+#define UART_DEFINE_POLLING(n) \
+  UART_desc_t g_UART##n = { \
+    (volatile UART_t*) &UART##n, \
+    { NULL, 0, 0, 0, 0 }, \
+    { NULL, 0, 0, 0, 0 } \
+  };
+
+
+/**
+  \def UART_DEFINE_BUFFERED(n,isr)
+
+  \brief define ring buffers, descriptor g_UARTn and interrupts for buffered mode
+
+  define send & receive buffers of size UARTn_TX_BUFFER_SIZE and UARTn_RX_BUFFER_SIZE,
+  descriptor g_UARTn and the interrupt handlers UARTisr_TXE_ISR() and UARTisr_RXF_ISR().
+  Parameter isr is 1 for UART1 and 234 for UART2..4, which share the same vectors.
+  Requires stm8_interrupt_vector.h
+*/
+#define UART_DEFINE_BUFFERED(n,isr) \
+  static uint8_t    m_UART##n##_bufTx[UART##n##_TX_BUFFER_SIZE]; \
+  static uint8_t    m_UART##n##_bufRx[UART##n##_RX_BUFFER_SIZE]; \
+  UART_desc_t g_UART##n = { \
+    (volatile UART_t*) &UART##n, \
+    { m_UART##n##_bufTx, UART##n##_TX_BUFFER_SIZE-1, 0, 0, 0 }, \
+    { m_UART##n##_bufRx, UART##n##_RX_BUFFER_SIZE-1, 0, 0, 0 }, \
+    NULL, 0, NULL, NULL, NULL, 0 \
+  }; \
+  ISR_HANDLER(UART##isr##_TXE_ISR, __UART##isr##_TXE_VECTOR__) { UART_TXE_handler(&g_UART##n); } \
+  ISR_HANDLER(UART##isr##_RXF_ISR, __UART##isr##_RXF_VECTOR__) { UART_RXF_handler(&g_UART##n); }
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif  // _UART_H_
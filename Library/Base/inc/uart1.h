@@ -8,9 +8,14 @@
   \brief declaration of UART1 / USART functions & macros
    
   declaration of UART1 / USART functions and macros for send & receive.
+  Functions are generated via UART_DECLARE_POLLING() or UART_DECLARE_BUFFERED(),
+  see uart.h. Buffered mode is implemented in uart.c using descriptor g_UART1 (see uart1.c)
   Optional functionality via #define:
     - USE_UART1_TXE_ISR:  use TXE interrupt (default is w/o ISR)
     - USE_UART1_RXF_ISR:  use RXF interrupt (default is w/o ISR)
+    - USE_UART1_BUFFER:   interrupt driven send & receive via ring buffers (requires both ISRs)
+    - UART1_TX_BUFFER_SIZE: size of send buffer [B], power of 2 up to 128 (default 64)
+    - UART1_RX_BUFFER_SIZE: size of receive buffer [B], power of 2 up to 128 (default 32)
 */
 
 /*-----------------------------------------------------------------------------
@@ -25,126 +30,56 @@
 -----------------------------------------------------------------------------*/
 #include "stm8as.h"
 #include "config.h"
+#include "uart.h"
 
 
 /*-----------------------------------------------------------------------------
     DECLARATION OF GLOBAL MACROS
 -----------------------------------------------------------------------------*/
 
-// only if UART1_TXE interrupts are used
-#if defined(USE_UART1_TXE_ISR)
+// buffered mode requires both UART1 interrupts, which are then handled in uart1.c
+#if defined(USE_UART1_BUFFER)
 
-  /// enable UART1_TXE interrupt
-  #define UART1_enable_send_interrupt()  UART1.CR2.reg.TIEN = 1
+  #if !defined(USE_UART1_TXE_ISR) || !defined(USE_UART1_RXF_ISR)
+    #error USE_UART1_BUFFER requires USE_UART1_TXE_ISR and USE_UART1_RXF_ISR in config.h
+  #endif
 
-  /// disable UART1_TXE interrupt
-  #define UART1_disable_send_interrupt() UART1.CR2.reg.TIEN = 0
+  // default size of send buffer [B]
+  #if !defined(UART1_TX_BUFFER_SIZE)
+    #define UART1_TX_BUFFER_SIZE  64
+  #endif
 
-#endif
+  // default size of receive buffer [B]
+  #if !defined(UART1_RX_BUFFER_SIZE)
+    #define UART1_RX_BUFFER_SIZE  32
+  #endif
 
-// only if UART1_RXF interrupts are used
-#if defined(USE_UART1_RXF_ISR)
+  #if !UART_BUFFER_SIZE_OK(UART1_TX_BUFFER_SIZE)
+    #error UART1_TX_BUFFER_SIZE must be a power of 2 in range 2..128
+  #endif
+  #if !UART_BUFFER_SIZE_OK(UART1_RX_BUFFER_SIZE)
+    #error UART1_RX_BUFFER_SIZE must be a power of 2 in range 2..128
+  #endif
 
-  /// enable UART1_RXF interrupt
-  #define UART1_enable_receive_interrupt()  UART1.CR2.reg.RIEN = 1
+#endif // USE_UART1_BUFFER
 
-  /// disable UART1_RXF interrupt
-  #define UART1_disable_receive_interrupt() UART1.CR2.reg.RIEN = 0
 
+// with constant master clock calculate baudrate divider at compile time. Returns baudrate error [0.01%]
+#if defined(F_MASTER)
+  #define UART1_beginConst(BR)   UART_beginConst(&g_UART1, BR)
 #endif
 
 
-
-/*-----------------------------------------------------------------------------
-    DECLARATION OF GLOBAL FUNCTIONS
------------------------------------------------------------------------------*/
-
-/// init UART1 for communication
-void     UART1_begin(uint32_t BR);
-
-/// send arry of bytes via UART1
-void     UART1_writeBytes(uint16_t num, uint8_t *buf);
-
-
 /*-----------------------------------------------------------------------------
     DECLARATION OF GLOBAL INLINE FUNCTIONS
 -----------------------------------------------------------------------------*/
 
-/**
-  \fn void UART1_end(void)
-   
-  \brief UART1 disable sender & receiver
-
-  UART1 disable sender & receiver. Retain previous settings
-*/
-INLINE void UART1_end(void) {
-
-  // disable sender & receiver
-  UART1.CR2.reg.TEN = 0;
-  UART1.CR2.reg.REN = 0;
-  
-} // UART1_end
-
-
-
-/**
-  \fn uint8_t UART1_available(void)
-   
-  \brief UART1 check if data available
-  
-  \return  1=data waiting, 0=receive buffer empty
-
-  UART1 check if data is available
-*/
-INLINE uint8_t UART1_available(void) {
-
-  // return if data in Rx buffer
-  return(UART1.SR.reg.RXNE);
-  
-} // UART1_available
-
-
-
-/**
-  \fn void  UART1_write(uint8_t data)
-   
-  \brief send byte via UART1
-  
-  \param[in]  data   byte to send
-
-  send byte via UART1 as soon as possible
-*/
-INLINE void UART1_write(uint8_t data) {
-
-  // wait until TX buffer is available
-  while (!(UART1.SR.reg.TXE));
-    
-  // send byte
-  UART1.DR.byte = data;
-  
-} // UART1_write
-
-
-
-/**
-  \fn uint8_t UART1_read(void)
-   
-  \brief UART1 byte receive function. Blocking
-  
-  \return received byte
-  
-  wait until byte received via UART1 and return content of Rx register
-*/
-INLINE uint8_t UART1_read(void) {
-
-  // wait until byte received
-  while (!(UART1.SR.reg.RXNE));
-
-  // return Rx buffer
-  return(UART1.DR.byte);
-
-} // UART1_read
-
+// declare g_UART1 and UART1_begin(), UART1_write() etc., see uart.h
+#if defined(USE_UART1_BUFFER)
+  UART_DECLARE_BUFFERED(1)
+#else
+  UART_DECLARE_POLLING(1)
+#endif
 
 
 /*-----------------------------------------------------------------------------
@@ -8,9 +8,14 @@
   \brief declaration of UART2 / LINUART functions & macros
    
   declaration of UART2 / LINUART functions and macros for send & receive.
+  Functions are generated via UART_DECLARE_POLLING() or UART_DECLARE_BUFFERED(),
+  see uart.h. Buffered mode is implemented in uart.c using descriptor g_UART2 (see uart2.c)
   Optional functionality via #define:
     - USE_UART234_TXE_ISR:  use TXE interrupt (shared with UART3+4, default is w/o ISR)
     - USE_UART234_RXF_ISR:  use RXF interrupt (shared with UART3+4, default is w/o ISR)
+    - USE_UART2_BUFFER:   interrupt driven send & receive via ring buffers (requires both ISRs)
+    - UART2_TX_BUFFER_SIZE: size of send buffer [B], power of 2 up to 128 (default 64)
+    - UART2_RX_BUFFER_SIZE: size of receive buffer [B], power of 2 up to 128 (default 32)
 */
 
 /*-----------------------------------------------------------------------------
@@ -25,126 +30,56 @@
 -----------------------------------------------------------------------------*/
 #include "stm8as.h"
 #include "config.h"
+#include "uart.h"
 
 
 /*-----------------------------------------------------------------------------
     DECLARATION OF GLOBAL MACROS
 -----------------------------------------------------------------------------*/
 
-// only if UART2_TXE interrupts are used
-#if defined(USE_UART234_TXE_ISR)
+// buffered mode requires both UART2 interrupts, which are then handled in uart2.c
+#if defined(USE_UART2_BUFFER)
 
-  /// enable UART2_TXE interrupt
-  #define UART2_enable_send_interrupt()  UART2.CR2.reg.TIEN = 1
+  #if !defined(USE_UART234_TXE_ISR) || !defined(USE_UART234_RXF_ISR)
+    #error USE_UART2_BUFFER requires USE_UART234_TXE_ISR and USE_UART234_RXF_ISR in config.h
+  #endif
 
-  /// disable UART2_TXE interrupt
-  #define UART2_disable_send_interrupt() UART2.CR2.reg.TIEN = 0
+  // default size of send buffer [B]
+  #if !defined(UART2_TX_BUFFER_SIZE)
+    #define UART2_TX_BUFFER_SIZE  64
+  #endif
 
-#endif
+  // default size of receive buffer [B]
+  #if !defined(UART2_RX_BUFFER_SIZE)
+    #define UART2_RX_BUFFER_SIZE  32
+  #endif
 
-// only if UART2_RXF interrupts are used
-#if defined(USE_UART234_RXF_ISR)
+  #if !UART_BUFFER_SIZE_OK(UART2_TX_BUFFER_SIZE)
+    #error UART2_TX_BUFFER_SIZE must be a power of 2 in range 2..128
+  #endif
+  #if !UART_BUFFER_SIZE_OK(UART2_RX_BUFFER_SIZE)
+    #error UART2_RX_BUFFER_SIZE must be a power of 2 in range 2..128
+  #endif
 
-  /// enable UART2_RXF interrupt
-  #define UART2_enable_receive_interrupt()  UART2.CR2.reg.RIEN = 1
+#endif // USE_UART2_BUFFER
 
-  /// disable UART2_RXF interrupt
-  #define UART2_disable_receive_interrupt() UART2.CR2.reg.RIEN = 0
 
+// with constant master clock calculate baudrate divider at compile time. Returns baudrate error [0.01%]
+#if defined(F_MASTER)
+  #define UART2_beginConst(BR)   UART_beginConst(&g_UART2, BR)
 #endif
 
 
-
-/*-----------------------------------------------------------------------------
-    DECLARATION OF GLOBAL FUNCTIONS
------------------------------------------------------------------------------*/
-
-/// init UART2 for communication
-void     UART2_begin(uint32_t BR);
-
-/// send arry of bytes via UART2
-void     UART2_writeBytes(uint16_t num, uint8_t *buf);
-
-
 /*-----------------------------------------------------------------------------
     DECLARATION OF GLOBAL INLINE FUNCTIONS
 -----------------------------------------------------------------------------*/
 
-/**
-  \fn void UART2_end(void)
-   
-  \brief UART2 disable sender & receiver
-
-  UART2 disable sender & receiver. Retain previous settings
-*/
-INLINE void UART2_end(void) {
-
-  // disable sender & receiver
-  UART2.CR2.reg.TEN = 0;
-  UART2.CR2.reg.REN = 0;
-  
-} // UART2_end
-
-
-
-/**
-  \fn uint8_t UART2_available(void)
-   
-  \brief UART2 check if data available
-  
-  \return  1=data waiting, 0=receive buffer empty
-
-  UART2 check if data is available
-*/
-INLINE uint8_t UART2_available(void) {
-
-  // return if data in Rx buffer
-  return(UART2.SR.reg.RXNE);
-  
-} // UART2_available
-
-
-
-/**
-  \fn void  UART2_write(uint8_t data)
-   
-  \brief send byte via UART2
-  
-  \param[in]  data   byte to send
-
-  send byte via UART2 as soon as possible
-*/
-INLINE void UART2_write(uint8_t data) {
-
-  // wait until TX buffer is available
-  while (!(UART2.SR.reg.TXE));
-    
-  // send byte
-  UART2.DR.byte = data;
-  
-} // UART2_write
-
-
-
-/**
-  \fn uint8_t UART2_read(void)
-   
-  \brief UART2 byte receive function. Blocking
-  
-  \return received byte
-  
-  wait until byte received via UART2 and return content of Rx register
-*/
-INLINE uint8_t UART2_read(void) {
-
-  // wait until byte received
-  while (!(UART2.SR.reg.RXNE));
-
-  // return Rx buffer
-  return(UART2.DR.byte);
-
-} // UART2_read
-
+// declare g_UART2 and UART2_begin(), UART2_write() etc., see uart.h
+#if defined(USE_UART2_BUFFER)
+  UART_DECLARE_BUFFERED(2)
+#else
+  UART_DECLARE_POLLING(2)
+#endif
 
 
 /*-----------------------------------------------------------------------------
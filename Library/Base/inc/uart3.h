@@ -8,9 +8,14 @@
   \brief declaration of UART3 / LINUART functions & macros
    
   declaration of UART3 / LINUART functions and macros for send & receive.
+  Functions are generated via UART_DECLARE_POLLING() or UART_DECLARE_BUFFERED(),
+  see uart.h. Buffered mode is implemented in uart.c using descriptor g_UART3 (see uart3.c)
   Optional functionality via #define:
     - USE_UART234_TXE_ISR:  use TXE interrupt (shared with UART2+4, default is w/o ISR)
     - USE_UART234_RXF_ISR:  use RXF interrupt (shared with UART2+4, default is w/o ISR)
+    - USE_UART3_BUFFER:   interrupt driven send & receive via ring buffers (requires both ISRs)
+    - UART3_TX_BUFFER_SIZE: size of send buffer [B], power of 2 up to 128 (default 64)
+    - UART3_RX_BUFFER_SIZE: size of receive buffer [B], power of 2 up to 128 (default 32)
 */
 
 /*-----------------------------------------------------------------------------
@@ -25,126 +30,56 @@
 -----------------------------------------------------------------------------*/
 #include "stm8as.h"
 #include "config.h"
+#include "uart.h"
 
 
 /*-----------------------------------------------------------------------------
     DECLARATION OF GLOBAL MACROS
 -----------------------------------------------------------------------------*/
 
-// only if UART3_TXE interrupts are used
-#if defined(USE_UART234_TXE_ISR)
+// buffered mode requires both UART3 interrupts, which are then handled in uart3.c
+#if defined(USE_UART3_BUFFER)
 
-  /// enable UART3_TXE interrupt
-  #define UART3_enable_send_interrupt()  UART3.CR2.reg.TIEN = 1
+  #if !defined(USE_UART234_TXE_ISR) || !defined(USE_UART234_RXF_ISR)
+    #error USE_UART3_BUFFER requires USE_UART234_TXE_ISR and USE_UART234_RXF_ISR in config.h
+  #endif
 
-  /// disable UART3_TXE interrupt
-  #define UART3_disable_send_interrupt() UART3.CR2.reg.TIEN = 0
+  // default size of send buffer [B]
+  #if !defined(UART3_TX_BUFFER_SIZE)
+    #define UART3_TX_BUFFER_SIZE  64
+  #endif
 
-#endif
+  // default size of receive buffer [B]
+  #if !defined(UART3_RX_BUFFER_SIZE)
+    #define UART3_RX_BUFFER_SIZE  32
+  #endif
 
-// only if UART3_RXF interrupts are used
-#if defined(USE_UART234_RXF_ISR)
+  #if !UART_BUFFER_SIZE_OK(UART3_TX_BUFFER_SIZE)
+    #error UART3_TX_BUFFER_SIZE must be a power of 2 in range 2..128
+  #endif
+  #if !UART_BUFFER_SIZE_OK(UART3_RX_BUFFER_SIZE)
+    #error UART3_RX_BUFFER_SIZE must be a power of 2 in range 2..128
+  #endif
 
-  /// enable UART3_RXF interrupt
-  #define UART3_enable_receive_interrupt()  UART3.CR2.reg.RIEN = 1
+#endif // USE_UART3_BUFFER
 
-  /// disable UART3_RXF interrupt
-  #define UART3_disable_receive_interrupt() UART3.CR2.reg.RIEN = 0
 
+// with constant master clock calculate baudrate divider at compile time. Returns baudrate error [0.01%]
+#if defined(F_MASTER)
+  #define UART3_beginConst(BR)   UART_beginConst(&g_UART3, BR)
 #endif
 
 
-
-/*-----------------------------------------------------------------------------
-    DECLARATION OF GLOBAL FUNCTIONS
------------------------------------------------------------------------------*/
-
-/// init UART3 for communication
-void     UART3_begin(uint32_t BR);
-
-/// send arry of bytes via UART3
-void     UART3_writeBytes(uint16_t num, uint8_t *buf);
-
-
 /*-----------------------------------------------------------------------------
     DECLARATION OF GLOBAL INLINE FUNCTIONS
 -----------------------------------------------------------------------------*/
 
-/**
-  \fn void UART3_end(void)
-   
-  \brief UART3 disable sender & receiver
-
-  UART3 disable sender & receiver. Retain previous settings
-*/
-INLINE void UART3_end(void) {
-
-  // disable sender & receiver
-  UART3.CR2.reg.TEN = 0;
-  UART3.CR2.reg.REN = 0;
-  
-} // UART3_end
-
-
-
-/**
-  \fn uint8_t UART3_available(void)
-   
-  \brief UART3 check if data available
-  
-  \return  1=data waiting, 0=receive buffer empty
-
-  UART3 check if data is available
-*/
-INLINE uint8_t UART3_available(void) {
-
-  // return if data in Rx buffer
-  return(UART3.SR.reg.RXNE);
-  
-} // UART3_available
-
-
-
-/**
-  \fn void  UART3_write(uint8_t data)
-   
-  \brief send byte via UART3
-  
-  \param[in]  data   byte to send
-
-  send byte via UART3 as soon as possible
-*/
-INLINE void UART3_write(uint8_t data) {
-
-  // wait until TX buffer is available
-  while (!(UART3.SR.reg.TXE));
-    
-  // send byte
-  UART3.DR.byte = data;
-  
-} // UART3_write
-
-
-
-/**
-  \fn uint8_t UART3_read(void)
-   
-  \brief UART3 byte receive function. Blocking
-  
-  \return received byte
-  
-  wait until byte received via UART3 and return content of Rx register
-*/
-INLINE uint8_t UART3_read(void) {
-
-  // wait until byte received
-  while (!(UART3.SR.reg.RXNE));
-
-  // return Rx buffer
-  return(UART3.DR.byte);
-
-} // UART3_read
-
+// declare g_UART3 and UART3_begin(), UART3_write() etc., see uart.h
+#if defined(USE_UART3_BUFFER)
+  UART_DECLARE_BUFFERED(3)
+#else
+  UART_DECLARE_POLLING(3)
+#endif
 
 
 /*-----------------------------------------------------------------------------
@@ -8,9 +8,14 @@
   \brief declaration of UART4 / LINUART functions & macros
    
   declaration of UART4 / LINUART functions and macros for send & receive.
+  Functions are generated via UART_DECLARE_POLLING() or UART_DECLARE_BUFFERED(),
+  see uart.h. Buffered mode is implemented in uart.c using descriptor g_UART4 (see uart4.c)
   Optional functionality via #define:
     - USE_UART234_TXE_ISR:  use TXE interrupt (shared with UART2+3, default is w/o ISR)
     - USE_UART234_RXF_ISR:  use RXF interrupt (shared with UART2+3, default is w/o ISR)
+    - USE_UART4_BUFFER:   interrupt driven send & receive via ring buffers (requires both ISRs)
+    - UART4_TX_BUFFER_SIZE: size of send buffer [B], power of 2 up to 128 (default 64)
+    - UART4_RX_BUFFER_SIZE: size of receive buffer [B], power of 2 up to 128 (default 32)
 */
 
 /*-----------------------------------------------------------------------------
@@ -25,126 +30,56 @@
 -----------------------------------------------------------------------------*/
 #include "stm8as.h"
 #include "config.h"
+#include "uart.h"
 
 
 /*-----------------------------------------------------------------------------
     DECLARATION OF GLOBAL MACROS
 -----------------------------------------------------------------------------*/
 
-// only if UART4_TXE interrupts are used
-#if defined(USE_UART234_TXE_ISR)
+// buffered mode requires both UART4 interrupts, which are then handled in uart4.c
+#if defined(USE_UART4_BUFFER)
 
-  /// enable UART4_TXE interrupt
-  #define UART4_enable_send_interrupt()  UART4.CR2.reg.TIEN = 1
+  #if !defined(USE_UART234_TXE_ISR) || !defined(USE_UART234_RXF_ISR)
+    #error USE_UART4_BUFFER requires USE_UART234_TXE_ISR and USE_UART234_RXF_ISR in config.h
+  #endif
 
-  /// disable UART4_TXE interrupt
-  #define UART4_disable_send_interrupt() UART4.CR2.reg.TIEN = 0
+  // default size of send buffer [B]
+  #if !defined(UART4_TX_BUFFER_SIZE)
+    #define UART4_TX_BUFFER_SIZE  64
+  #endif
 
-#endif
+  // default size of receive buffer [B]
+  #if !defined(UART4_RX_BUFFER_SIZE)
+    #define UART4_RX_BUFFER_SIZE  32
+  #endif
 
-// only if UART4_RXF interrupts are used
-#if defined(USE_UART234_RXF_ISR)
+  #if !UART_BUFFER_SIZE_OK(UART4_TX_BUFFER_SIZE)
+    #error UART4_TX_BUFFER_SIZE must be a power of 2 in range 2..128
+  #endif
+  #if !UART_BUFFER_SIZE_OK(UART4_RX_BUFFER_SIZE)
+    #error UART4_RX_BUFFER_SIZE must be a power of 2 in range 2..128
+  #endif
 
-  /// enable UART4_RXF interrupt
-  #define UART4_enable_receive_interrupt()  UART4.CR2.reg.RIEN = 1
+#endif // USE_UART4_BUFFER
 
-  /// disable UART4_RXF interrupt
-  #define UART4_disable_receive_interrupt() UART4.CR2.reg.RIEN = 0
 
+// with constant master clock calculate baudrate divider at compile time. Returns baudrate error [0.01%]
+#if defined(F_MASTER)
+  #define UART4_beginConst(BR)   UART_beginConst(&g_UART4, BR)
 #endif
 
 
-
-/*-----------------------------------------------------------------------------
-    DECLARATION OF GLOBAL FUNCTIONS
------------------------------------------------------------------------------*/
-
-/// init UART4 for communication
-void     UART4_begin(uint32_t BR);
-
-/// send arry of bytes via UART4
-void     UART4_writeBytes(uint16_t num, uint8_t *buf);
-
-
 /*-----------------------------------------------------------------------------
     DECLARATION OF GLOBAL INLINE FUNCTIONS
 -----------------------------------------------------------------------------*/
 
-/**
-  \fn void UART4_end(void)
-   
-  \brief UART4 disable sender & receiver
-
-  UART4 disable sender & receiver. Retain previous settings
-*/
-INLINE void UART4_end(void) {
-
-  // disable sender & receiver
-  UART4.CR2.reg.TEN = 0;
-  UART4.CR2.reg.REN = 0;
-  
-} // UART4_end
-
-
-
-/**
-  \fn uint8_t UART4_available(void)
-   
-  \brief UART4 check if data available
-  
-  \return  1=data waiting, 0=receive buffer empty
-
-  UART4 check if data is available
-*/
-INLINE uint8_t UART4_available(void) {
-
-  // return if data in Rx buffer
-  return(UART4.SR.reg.RXNE);
-  
-} // UART4_available
-
-
-
-/**
-  \fn void  UART4_write(uint8_t data)
-   
-  \brief send byte via UART4
-  
-  \param[in]  data   byte to send
-
-  send byte via UART4 as soon as possible
-*/
-INLINE void UART4_write(uint8_t data) {
-
-  // wait until TX buffer is available
-  while (!(UART4.SR.reg.TXE));
-    
-  // send byte
-  UART4.DR.byte = data;
-  
-} // UART4_write
-
-
-
-/**
-  \fn uint8_t UART4_read(void)
-   
-  \brief UART4 byte receive function. Blocking
-  
-  \return received byte
-  
-  wait until byte received via UART4 and return content of Rx register
-*/
-INLINE uint8_t UART4_read(void) {
-
-  // wait until byte received
-  while (!(UART4.SR.reg.RXNE));
-
-  // return Rx buffer
-  return(UART4.DR.byte);
-
-} // UART4_read
-
+// declare g_UART4 and UART4_begin(), UART4_write() etc., see uart.h
+#if defined(USE_UART4_BUFFER)
+  UART_DECLARE_BUFFERED(4)
+#else
+  UART_DECLARE_POLLING(4)
+#endif
 
 
 /*-----------------------------------------------------------------------------
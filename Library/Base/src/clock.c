@@ -0,0 +1,62 @@
+/**
+  \file clock.c
+
+  \author G. Icking-Konert
+  \date 2026-10-17
+  \version 0.1
+
+  \brief implementation of clock functions & macros
+
+  implementation of functions to query the master clock f_MASTER.
+  If F_MASTER is defined in config.h, all functionality is provided
+  by macros in clock.h
+*/
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "stm8as.h"
+#include "config.h"
+#include "clock.h"
+
+
+/*----------------------------------------------------------
+    FUNCTIONS
+----------------------------------------------------------*/
+
+#if !defined(F_MASTER)
+
+/**
+  \fn uint32_t CLK_getMaster(void)
+
+  \brief get master clock frequency
+
+  \return master clock f_MASTER [Hz]
+
+  get master clock f_MASTER from active clock source and HSI divider.
+  For HSE the frequency is HSE_VALUE (see clock.h).
+*/
+uint32_t CLK_getMaster(void) {
+
+  // get frequency of active clock source
+  switch (CLK.CMSR.byte) {
+
+    case CLK_SOURCE_LSI:
+      return(LSI_VALUE);
+
+    case CLK_SOURCE_HSE:
+      return(HSE_VALUE);
+
+    // HSI with prescaler 1, 2, 4 or 8
+    default:
+      return(HSI_VALUE >> CLK.CKDIVR.reg.HSIDIV);
+
+  } // switch (CMSR)
+
+} // CLK_getMaster
+
+#endif // F_MASTER
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
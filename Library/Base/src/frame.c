@@ -0,0 +1,245 @@
+/**
+  \file frame.c
+
+  \author G. Icking-Konert
+  \date 2026-10-17
+  \version 0.1
+
+  \brief implementation of framed packet protocol
+
+  implementation of functions for framed packet transfer via a byte stream, e.g. UART.
+  Frames are SLIP encoded (RFC 1055) and protected by a CRC16-CCITT.
+  For details see frame.h
+*/
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "stm8as.h"
+#include "config.h"
+#include "frame.h"
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF MODULE VARIABLES
+-----------------------------------------------------------------------------*/
+
+frame_stats_t       g_frameStats;                                 ///< receive statistics
+
+static void         (*m_frame_pSend)(uint8_t);                    ///< function to send one byte
+static void         (*m_frame_pReceive)(uint8_t, uint8_t*);       ///< function to call on received frame
+
+static uint8_t      m_frame_buf[FRAME_BUFFER_SIZE+2];             ///< receive buffer (payload + CRC)
+static uint8_t      m_frame_idx;                                  ///< number of bytes in receive buffer
+static uint16_t     m_frame_crc;                                  ///< running CRC over received bytes
+static uint8_t      m_frame_flagEsc;                              ///< last byte was SLIP_ESC
+static uint8_t      m_frame_flagErr;                              ///< error in current frame -> ignore until next SLIP_END
+
+
+/*----------------------------------------------------------
+    MODULE FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn void frame_sendEscaped(uint8_t data)
+
+  \brief send one byte with SLIP escaping
+
+  \param[in]  data    byte to send
+
+  send one byte via attached send function. Replace special
+  characters by respective escape sequence
+*/
+static void frame_sendEscaped(uint8_t data) {
+
+  if (data == SLIP_END) {
+    m_frame_pSend(SLIP_ESC);
+    m_frame_pSend(SLIP_ESC_END);
+  }
+  else if (data == SLIP_ESC) {
+    m_frame_pSend(SLIP_ESC);
+    m_frame_pSend(SLIP_ESC_ESC);
+  }
+  else
+    m_frame_pSend(data);
+
+} // frame_sendEscaped
+
+
+
+/*----------------------------------------------------------
+    GLOBAL FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn uint16_t frame_crc16(uint16_t crc, uint8_t data)
+
+  \brief update CRC16-CCITT with one byte
+
+  \param[in]  crc     CRC of previous bytes. Start with 0xFFFF
+  \param[in]  data    next byte
+
+  \return  updated CRC
+
+  update CRC16-CCITT (poly 0x1021, MSB first) with one byte. Uses
+  shifts instead of a table or bit loop, i.e. fast and small.
+  Appending the CRC MSB first results in CRC=0 over the complete frame.
+*/
+uint16_t frame_crc16(uint16_t crc, uint8_t data) {
+
+  uint8_t   x;
+
+  x  = (uint8_t) (crc >> 8) ^ data;
+  x ^= x >> 4;
+
+  return((crc << 8) ^ ((uint16_t) x << 12) ^ ((uint16_t) x << 5) ^ (uint16_t) x);
+
+} // frame_crc16
+
+
+
+/**
+  \fn void frame_begin(void (*pSend)(uint8_t), void (*pReceive)(uint8_t, uint8_t*))
+
+  \brief init frame protocol
+
+  \param[in]  pSend     function to send one byte, e.g. UART1_write
+  \param[in]  pReceive  function called on received frame with payload size and buffer
+
+  init frame protocol and reset receive state machine and statistics.
+  Note: pReceive is called from context of frame_receiveByte(), e.g. ISR.
+  Buffer is only valid until pReceive returns.
+*/
+void frame_begin(void (*pSend)(uint8_t), void (*pReceive)(uint8_t, uint8_t*)) {
+
+  // store functions
+  m_frame_pSend    = pSend;
+  m_frame_pReceive = pReceive;
+
+  // reset receive state machine
+  m_frame_idx     = 0;
+  m_frame_crc     = 0xFFFF;
+  m_frame_flagEsc = 0;
+  m_frame_flagErr = 0;
+
+  // reset statistics
+  frame_clearStats();
+
+} // frame_begin
+
+
+
+/**
+  \fn void frame_send(uint8_t num, uint8_t *buf)
+
+  \brief send frame
+
+  \param[in]  num     payload size [B]
+  \param[in]  buf     payload
+
+  send payload as SLIP frame with CRC16. A leading SLIP_END
+  terminates any noise on the line, i.e. receiver resyncs
+*/
+void frame_send(uint8_t num, uint8_t *buf) {
+
+  uint16_t  crc = 0xFFFF;
+  uint8_t   i;
+
+  // start new frame
+  m_frame_pSend(SLIP_END);
+
+  // send payload
+  for (i=0; i<num; i++) {
+    crc = frame_crc16(crc, buf[i]);
+    frame_sendEscaped(buf[i]);
+  }
+
+  // send CRC (MSB first) and end frame
+  frame_sendEscaped((uint8_t) (crc >> 8));
+  frame_sendEscaped((uint8_t) crc);
+  m_frame_pSend(SLIP_END);
+
+} // frame_send
+
+
+
+/**
+  \fn void frame_receiveByte(uint8_t data)
+
+  \brief frame receive state machine
+
+  \param[in]  data    received byte
+
+  process one received byte. On SLIP_END check the CRC and pass a valid
+  frame to the receive callback. Erroneous frames are counted and dropped.
+  Is short enough to be called from ISR, e.g. via UART1_attachReceive()
+*/
+void frame_receiveByte(uint8_t data) {
+
+  // end of frame
+  if (data == SLIP_END) {
+
+    // frame with valid CRC (residue is 0) -> pass payload to callback
+    if (!m_frame_flagErr) {
+      if (m_frame_idx >= 2) {
+        if (m_frame_crc == 0) {
+          g_frameStats.numOk++;
+          if (m_frame_pReceive != NULL)
+            m_frame_pReceive(m_frame_idx-2, m_frame_buf);
+        }
+        else
+          g_frameStats.errCrc++;
+      }
+      else if (m_frame_idx != 0)      // empty frames are ignored, e.g. leading SLIP_END
+        g_frameStats.errCrc++;
+    }
+
+    // start next frame
+    m_frame_idx     = 0;
+    m_frame_crc     = 0xFFFF;
+    m_frame_flagEsc = 0;
+    m_frame_flagErr = 0;
+    return;
+
+  } // SLIP_END
+
+  // after error ignore all bytes until next SLIP_END
+  if (m_frame_flagErr)
+    return;
+
+  // start of escape sequence
+  if (data == SLIP_ESC) {
+    m_frame_flagEsc = 1;
+    return;
+  }
+
+  // resolve escape sequence
+  if (m_frame_flagEsc) {
+    m_frame_flagEsc = 0;
+    if (data == SLIP_ESC_END)
+      data = SLIP_END;
+    else if (data == SLIP_ESC_ESC)
+      data = SLIP_ESC;
+    else {
+      g_frameStats.errEscape++;
+      m_frame_flagErr = 1;
+      return;
+    }
+  }
+
+  // frame too long
+  if (m_frame_idx >= FRAME_BUFFER_SIZE+2) {
+    g_frameStats.errOverflow++;
+    m_frame_flagErr = 1;
+    return;
+  }
+
+  // store byte and update CRC
+  m_frame_buf[m_frame_idx++] = data;
+  m_frame_crc = frame_crc16(m_frame_crc, data);
+
+} // frame_receiveByte
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
@@ -25,6 +25,14 @@
  
 volatile uint8_t (*m_getchar_Rx_pFct)(void) = getchar_Default;   ///< pointer to gets()/getchar() receive routine
 
+static char       *m_gets_buf;                                  ///< line assembler: buffer for line
+static uint8_t    m_gets_size;                                  ///< line assembler: buffer size incl. NUL
+static uint8_t    m_gets_idx;                                   ///< line assembler: number of chars in buffer
+static uint8_t    m_gets_last;                                  ///< line assembler: last received char (for CR+LF)
+static void       (*m_gets_pEcho)(uint8_t);                     ///< line assembler: echo function or NULL
+
+volatile uint8_t  g_gets_flagReady = 0;                         ///< line assembler: complete line in buffer
+
 
 /*----------------------------------------------------------
     FUNCTIONS
@@ -104,6 +112,109 @@ char getchar(void) {
 } // getchar
 
 
+
+/**
+  \fn void gets_begin(char *buf, uint8_t size, void (*pEcho)(uint8_t))
+   
+  \brief init non-blocking line assembler
+  
+  \param[in]  buf     buffer for line
+  \param[in]  size    size of buffer, i.e. max. line length + 1
+  \param[in]  pEcho   function to echo input, e.g. UART1_write. NULL for no echo
+   
+  init line assembler, which collects characters passed via gets_feed() 
+  into a line. Unlike gets() it never blocks, i.e. the main loop continues
+  while waiting for input. Line is complete if gets_ready() is true
+*/
+void gets_begin(char *buf, uint8_t size, void (*pEcho)(uint8_t)) {
+
+  m_gets_buf   = buf;
+  m_gets_size  = size;
+  m_gets_pEcho = pEcho;
+  gets_release();
+    
+} // gets_begin
+
+
+
+/**
+  \fn void gets_feed(uint8_t c)
+   
+  \brief pass received character to line assembler
+  
+  \param[in]  c       received character
+   
+  add character to line. Supports backspace/DEL, echo and max. length.
+  Line is terminated by CR or LF (CR+LF counts as one). Characters 
+  received while a complete line is pending are ignored.
+  Is short enough to be called from a receive ISR, e.g. via UART1_attachReceive()
+*/
+void gets_feed(uint8_t c) {
+
+  uint8_t   last = m_gets_last;
+
+  // store for CR+LF detection
+  m_gets_last = c;
+
+  // previous line not yet read -> ignore
+  if (g_gets_flagReady)
+    return;
+
+  // end of line (ignore LF after CR)
+  if ((c == '\r') || (c == '\n')) {
+    if ((c == '\n') && (last == '\r'))
+      return;
+    m_gets_buf[m_gets_idx] = '\0';
+    g_gets_flagReady = 1;
+    if (m_gets_pEcho != NULL) {
+      m_gets_pEcho('\r');
+      m_gets_pEcho('\n');
+    }
+    return;
+  }
+
+  // backspace or DEL -> remove last char
+  if ((c == '\b') || (c == 127)) {
+    if (m_gets_idx) {
+      m_gets_idx--;
+      if (m_gets_pEcho != NULL) {
+        m_gets_pEcho('\b');
+        m_gets_pEcho(' ');
+        m_gets_pEcho('\b');
+      }
+    }
+    return;
+  }
+
+  // ignore other control chars and chars exceeding buffer
+  if ((c < ' ') || (m_gets_idx >= m_gets_size-1))
+    return;
+
+  // store and echo char
+  m_gets_buf[m_gets_idx++] = c;
+  if (m_gets_pEcho != NULL)
+    m_gets_pEcho(c);
+    
+} // gets_feed
+
+
+
+/**
+  \fn void gets_release(void)
+   
+  \brief release line buffer for next line
+  
+  release line buffer after processing a complete line. Then
+  next line is collected by gets_feed()
+*/
+void gets_release(void) {
+
+  m_gets_idx = 0;
+  g_gets_flagReady = 0;
+    
+} // gets_release
+
+
 /*-----------------------------------------------------------------------------
     END OF MODULE
 -----------------------------------------------------------------------------*/
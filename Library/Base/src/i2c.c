@@ -20,44 +20,673 @@
   #include "i2c.h"
 #undef _I2C_MAIN_
 #include "gpio.h"
+#include "clock.h"
+#include "sw_delay.h"
+#if defined(USE_I2C_QUEUE)
+  #include "timer4.h"
+#endif
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF MODULE VARIABLES
+-----------------------------------------------------------------------------*/
+
+i2c_stats_t      g_i2c_stats;                         ///< error statistics
+uint8_t          g_i2c_present[16] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                                      0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};  ///< presence cache, 1 bit per 7b address. Unknown=present
+static uint32_t  m_i2c_speed = I2C_SPEED_STANDARD;    ///< SCL frequency [Hz] of last i2c_begin(), restored by i2c_init()
+
+#if defined(USE_I2C_QUEUE)
+
+  // I2C interrupt enable masks (register ITR)
+  #define I2C_ITR_EVT   0x03                            ///< error + event interrupts (SB, ADDR, BTF)
+  #define I2C_ITR_BUF   0x07                            ///< additionally buffer interrupts (TXE, RXNE)
+
+  i2c_trans_t * volatile  g_i2c_pQueue = NULL;          ///< active transaction and head of queue
+  static i2c_trans_t      *m_i2c_pTail;                 ///< last transaction in queue
+  static uint8_t          m_i2c_itr;                    ///< I2C interrupt mask requested by ISR
+  static uint8_t          m_i2c_idx;                    ///< number of bytes transferred in current phase
+  static uint8_t          m_i2c_flagRead;               ///< current phase: 0=write, 1=read
+  static uint8_t          m_i2c_flagAddr;               ///< address sent but not yet acknowledged
+  static uint32_t         m_i2c_timeStart;              ///< start time [ms] of active transaction for watchdog
+
+#endif // USE_I2C_QUEUE
 
 
 /*----------------------------------------------------------
-    FUNCTIONS
+    MODULE FUNCTIONS
 ----------------------------------------------------------*/
 
 /**
-  \fn void i2c_init(void)
+  \fn void i2c_countError(uint8_t err)
    
-  \brief configure I2C bus
+  \brief count error in statistics
 
-  configure I2C bus as master in standard mode, BR=100kHz, 7bit address, 250ns rise time
+  \param[in]  err   error code I2C_ERR_xxx. I2C_OK is ignored
+
+  increment error counter. Counters saturate, i.e. don't wrap around
 */
-void i2c_init() {
+static void i2c_countError(uint8_t err) {
+
+  if ((err != I2C_OK) && (err <= I2C_NUM_ERR) && (g_i2c_stats.err[err-1] != 0xFFFF))
+    g_i2c_stats.err[err-1]++;
+
+} // i2c_countError
+
+
+
+/**
+  \fn void i2c_setPresent(uint8_t addr, uint8_t flag)
+   
+  \brief update presence cache
+
+  \param[in]  addr    7b address [6:0] of I2C slave
+  \param[in]  flag    1=slave present, 0=absent
+*/
+static void i2c_setPresent(uint8_t addr, uint8_t flag) {
+
+  uint8_t   mask = (uint8_t) (1 << (addr & 0x07));
+
+  addr = (addr >> 3) & 0x0F;
+  if (flag)
+    g_i2c_present[addr] |= mask;
+  else
+    g_i2c_present[addr] &= ~mask;
+
+} // i2c_setPresent
+
+
+
+#if defined(USE_I2C_QUEUE)
+
+  /**
+    \fn void i2c_abortQueue(i2c_trans_t *pTrans, uint8_t status)
+   
+    \brief finish detached transactions with error
+
+    \param[in]  pTrans    first detached transaction (NULL=none)
+    \param[in]  status    error code of first transaction. Following ones get I2C_ERR_ABORT
+
+    set status of all transactions in list and call their completion callbacks.
+    List must already be removed from the queue, i.e. callbacks may submit again
+  */
+  static void i2c_abortQueue(i2c_trans_t *pTrans, uint8_t status) {
+
+    i2c_trans_t   *pNext;
+
+    while (pTrans != NULL) {
+      pNext = pTrans->pNext;              // callback may submit transaction again
+      pTrans->status = status;
+      i2c_countError(status);
+      if (pTrans->pCallback != NULL)
+        pTrans->pCallback(pTrans);
+      pTrans = pNext;
+      status = I2C_ERR_ABORT;
+    }
+
+  } // i2c_abortQueue
+
+#endif // USE_I2C_QUEUE
+
+
+
+/**
+  \fn uint8_t i2c_timeout(void)
+   
+  \brief handle I2C timeout
+
+  \return I2C_ERR_TIMEOUT
+
+  count timeout and recover I2C bus, e.g. if a slave holds SDA low
+*/
+static uint8_t i2c_timeout(void) {
+
+  i2c_countError(I2C_ERR_TIMEOUT);
+  i2c_recover();
+
+  return(I2C_ERR_TIMEOUT);
+
+} // i2c_timeout
+
+
+
+/**
+  \fn uint8_t i2c_waitEvent(uint8_t mask, uint8_t errNack)
+   
+  \brief wait for I2C event flag
+
+  \param[in]  mask      bitmask of flag(s) in SR1, e.g. 0x01=SB, 0x02=ADDR, 0x04=BTF, 0x40=RXNE, 0x80=TXE
+  \param[in]  errNack   error code to return on NACK, i.e. I2C_ERR_NACK_ADDR or I2C_ERR_NACK_DATA
+
+  \return error code (I2C_OK, I2C_ERR_TIMEOUT, I2C_ERR_ARLO, I2C_ERR_BUS or errNack)
+
+  wait until one of the flags in SR1 is set, an error occurs or timeout
+*/
+static uint8_t i2c_waitEvent(uint8_t mask, uint8_t errNack) {
+
+  uint16_t  countTimeout;     // use counter for timeout to minimize dependencies
+
+  countTimeout = 10000;                           // ~1.1us/inc -> ~10ms
+  while (!(I2C.SR1.byte & mask)) {
+    if (I2C.SR2.reg.AF) {
+      I2C.SR2.reg.AF = 0;
+      return(errNack);
+    }
+    if (I2C.SR2.reg.ARLO) {
+      I2C.SR2.reg.ARLO = 0;
+      return(I2C_ERR_ARLO);
+    }
+    if (I2C.SR2.reg.BERR) {
+      I2C.SR2.reg.BERR = 0;
+      return(I2C_ERR_BUS);
+    }
+    if (!(countTimeout--))
+      return(I2C_ERR_TIMEOUT);
+  }
+
+  return(I2C_OK);
+
+} // i2c_waitEvent
+
+
+
+/**
+  \fn uint8_t i2c_transmit(uint8_t addr, uint8_t numTx, uint8_t *bufTx)
+   
+  \brief send address + write flag and data
+ 
+  \param[in]  addr        7b address [6:0] of I2C slave
+  \param[in]  numTx       number of bytes to send (0=address only)
+  \param[in]  bufTx       send buffer
+
+  \return error code (I2C_OK or I2C_ERR_xxx)
+
+  write phase after (repeated) start condition. Wait until last byte is
+  transferred (BTF), i.e. a NACK of the last byte is detected as well.
+  On error return immediately, cleanup is done by caller
+*/
+static uint8_t i2c_transmit(uint8_t addr, uint8_t numTx, uint8_t *bufTx) {
+
+  uint8_t   i, err, dummy;
+
+  // send 7b slave address + write flag. Reading SR3 clears ADDR
+  I2C.DR.byte = (uint8_t) (addr << 1);
+  if ((err = i2c_waitEvent(0x02, I2C_ERR_NACK_ADDR)))
+    return(err);
+  dummy = I2C.SR3.byte;
+
+  // send data and wait until last byte is transferred (BTF)
+  for (i=0; i<numTx; i++) {
+    if ((err = i2c_waitEvent(0x80, I2C_ERR_NACK_DATA)))
+      return(err);
+    I2C.DR.byte = bufTx[i];
+  }
+  if (numTx != 0) {
+    if ((err = i2c_waitEvent(0x04, I2C_ERR_NACK_DATA)))
+      return(err);
+  }
+
+  // avoid compiler warning
+  (void) dummy;
+
+  return(I2C_OK);
+
+} // i2c_transmit
+
+
+
+/**
+  \fn uint8_t i2c_receive(uint8_t addr, uint8_t numRx, uint8_t *bufRx)
+   
+  \brief send address + read flag and receive data
+ 
+  \param[in]  addr        7b address [6:0] of I2C slave
+  \param[in]  numRx       number of bytes to receive (>=1)
+  \param[out] bufRx       receive buffer
+
+  \return error code (I2C_OK or I2C_ERR_xxx)
+
+  read phase after (repeated) start condition. The last byte is NACKed and
+  the stop condition is requested as required by the reference manual
+  (RM0016), i.e. 1 byte: NACK before clearing ADDR, 2 bytes: POS, >2 bytes:
+  last 3 bytes via BTF. On error return immediately, cleanup is done by caller
+*/
+static uint8_t i2c_receive(uint8_t addr, uint8_t numRx, uint8_t *bufRx) {
+
+  uint8_t   i, err, dummy;
+
+  // send 7b slave address + read flag
+  I2C.DR.byte = (uint8_t) ((addr << 1) | 0x01);
+  if ((err = i2c_waitEvent(0x02, I2C_ERR_NACK_ADDR)))
+    return(err);
+
+  // read 1 byte: NACK before clearing ADDR, then stop
+  if (numRx == 1) {
+    I2C.CR2.reg.ACK = 0;
+    dummy = I2C.SR3.byte;
+    I2C.CR2.reg.STOP = 1;
+    if ((err = i2c_waitEvent(0x40, I2C_ERR_NACK_DATA)))
+      return(err);
+    bufRx[0] = I2C.DR.byte;
+  }
+
+  // read 2 bytes: NACK applies to 2nd byte (POS). Both bytes received when BTF
+  else if (numRx == 2) {
+    I2C.CR2.reg.POS = 1;
+    dummy = I2C.SR3.byte;
+    I2C.CR2.reg.ACK = 0;
+    if ((err = i2c_waitEvent(0x04, I2C_ERR_NACK_DATA)))
+      return(err);
+    I2C.CR2.reg.STOP = 1;
+    bufRx[0] = I2C.DR.byte;
+    bufRx[1] = I2C.DR.byte;
+  }
+
+  // read N>2 bytes: via RXNE until 3 bytes are left, then via BTF
+  else {
+    dummy = I2C.SR3.byte;
+    for (i=0; i<numRx-3; i++) {
+      if ((err = i2c_waitEvent(0x40, I2C_ERR_NACK_DATA)))
+        return(err);
+      bufRx[i] = I2C.DR.byte;
+    }
+
+    // byte N-2 in DR, N-1 in shift register -> NACK last byte
+    if ((err = i2c_waitEvent(0x04, I2C_ERR_NACK_DATA)))
+      return(err);
+    I2C.CR2.reg.ACK = 0;
+    bufRx[i++] = I2C.DR.byte;
+
+    // byte N-1 in DR, N in shift register -> stop
+    if ((err = i2c_waitEvent(0x04, I2C_ERR_NACK_DATA)))
+      return(err);
+    I2C.CR2.reg.STOP = 1;
+    bufRx[i++] = I2C.DR.byte;
+    bufRx[i]   = I2C.DR.byte;
+  }
+
+  // avoid compiler warning
+  (void) dummy;
+
+  return(I2C_OK);
+
+} // i2c_receive
+
+
+
+/**
+  \fn uint8_t i2c_transfer(uint8_t addr, uint8_t numTx, uint8_t *bufTx, uint8_t numRx, uint8_t *bufRx)
+   
+  \brief blocking write-then-read transfer
+
+  \param[in]  addr        7b address [6:0] of I2C slave
+  \param[in]  numTx       number of bytes to send
+  \param[in]  bufTx       send buffer
+  \param[in]  numRx       number of bytes to receive
+  \param[out] bufRx       receive buffer
+
+  \return error code (I2C_OK or I2C_ERR_xxx)
+
+  transfer sequence for i2c_writeRead(). On error return immediately,
+  cleanup is done by caller
+*/
+static uint8_t i2c_transfer(uint8_t addr, uint8_t numTx, uint8_t *bufTx, uint8_t numRx, uint8_t *bufRx) {
+
+  uint8_t   err;
+
+  // generate start condition
+  I2C.CR2.reg.POS = 0;
+  I2C.CR2.reg.ACK = 1;
+  I2C.CR2.reg.START = 1;
+  if ((err = i2c_waitEvent(0x01, I2C_ERR_NACK_ADDR)))
+    return(err);
+
+  // write phase. W/o data only send address (=probe)
+  if ((numTx != 0) || (numRx == 0)) {
+
+    if ((err = i2c_transmit(addr, numTx, bufTx)))
+      return(err);
+
+    // write only -> done
+    if (numRx == 0) {
+      I2C.CR2.reg.STOP = 1;
+      return(I2C_OK);
+    }
+
+    // read follows -> repeated start
+    I2C.CR2.reg.START = 1;
+    if ((err = i2c_waitEvent(0x01, I2C_ERR_NACK_ADDR)))
+      return(err);
+
+  } // write phase
+
+  // read phase incl. stop
+  return(i2c_receive(addr, numRx, bufRx));
+
+} // i2c_transfer
+
+
+
+/**
+  \fn uint8_t i2c_result(uint8_t addr, uint8_t err)
+   
+  \brief handle result of i2c_send() or i2c_request()
+
+  \param[in]  addr        7b address [6:0] of I2C slave
+  \param[in]  err         error code (I2C_OK or I2C_ERR_xxx)
+
+  \return error code (=err)
+
+  on timeout count error and recover bus. Else count error and update
+  presence cache. On NACK the bus is not released, i.e. the caller
+  still has to generate a stop condition via i2c_stop()
+*/
+static uint8_t i2c_result(uint8_t addr, uint8_t err) {
+
+  // on timeout recover bus
+  if (err == I2C_ERR_TIMEOUT)
+    return(i2c_timeout());
+
+  // count error and update presence cache
+  i2c_countError(err);
+  if (err == I2C_OK)
+    i2c_setPresent(addr, 1);
+  else if (err == I2C_ERR_NACK_ADDR)
+    i2c_setPresent(addr, 0);
+
+  return(err);
+
+} // i2c_result
+
+
+
+/**
+  \fn uint8_t i2c_transferComplete(uint8_t addr, uint8_t numTx, uint8_t *bufTx, uint8_t numRx, uint8_t *bufRx)
+   
+  \brief blocking write-then-read transfer incl. error handling
+
+  \param[in]  addr        7b address [6:0] of I2C slave
+  \param[in]  numTx       number of bytes to send
+  \param[in]  bufTx       send buffer
+  \param[in]  numRx       number of bytes to receive
+  \param[out] bufRx       receive buffer
+
+  \return error code (I2C_OK or I2C_ERR_xxx)
+
+  wait for free bus, transfer data and release bus. On timeout recover bus.
+  Update presence cache, but don't count errors except timeout
+*/
+static uint8_t i2c_transferComplete(uint8_t addr, uint8_t numTx, uint8_t *bufTx, uint8_t numRx, uint8_t *bufRx) {
+
+  uint8_t   err;
+  uint16_t  countTimeout;     // use counter for timeout to minimize dependencies
+
+  // wait until bus is free
+  if (i2c_waitFree())
+    return(I2C_ERR_TIMEOUT);
+
+  // transfer data
+  err = i2c_transfer(addr, numTx, bufTx, numRx, bufRx);
+
+  // on timeout recover bus
+  if (err == I2C_ERR_TIMEOUT)
+    return(i2c_timeout());
+
+  // on NACK release bus
+  if (err != I2C_OK)
+    I2C.CR2.reg.STOP = 1;
+
+  // wait until stop condition is generated. Don't write CR2 meanwhile
+  countTimeout = 10000;                           // ~1.1us/inc -> ~10ms
+  while ((I2C.CR2.reg.STOP) && (countTimeout--));
+  I2C.CR2.reg.POS = 0;
+
+  // update presence cache
+  if (err == I2C_OK)
+    i2c_setPresent(addr, 1);
+  else if (err == I2C_ERR_NACK_ADDR)
+    i2c_setPresent(addr, 0);
+
+  return(err);
+
+} // i2c_transferComplete
+
+
+
+/*----------------------------------------------------------
+    GLOBAL FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn uint32_t i2c_config(uint32_t speed)
+   
+  \brief configure I2C module with given speed
+
+  \param[in]  speed   SCL frequency [Hz], max. 400kHz (see I2C_SPEED_STANDARD, I2C_SPEED_FAST)
+
+  \return actual SCL frequency [Hz] (<= speed). 0 if master clock <1MHz
+
+  configure I2C bus as master, 7bit address. Clock control (CCR, DUTY) and
+  max. rise time (TRISE) are calculated from actual master clock (see clock.h).
+  For speed <=100kHz use standard mode (t_low = t_high, t_rise<1000ns).
+  Else use fast mode (t_rise<300ns), where duty cycle t_low/t_high=2 or 16/9
+  is selected for the higher resulting speed. Fast mode requires >=4MHz master clock,
+  else 100kHz is used
+*/
+static uint32_t i2c_config(uint32_t speed) {
+
+  uint32_t  fMaster = CLK_getMaster();
+  uint32_t  ccr, ccr2, speed2;
+  uint8_t   freq, fs = 0, duty = 0;
 
   // configure I2C pins PE1(=SCL) and PE2(=SDA)
   pinMode(&PORT_E, 1, OUTPUT_OPENDRAIN);
   pinMode(&PORT_E, 2, OUTPUT_OPENDRAIN);
 
-  // init I2C bus
+  // init I2C bus. Clock registers can only be changed while disabled
   I2C.CR1.byte          = 0x00;     // disable I2C, no clock stretching
   I2C.CR2.byte          = 0x00;     // reset I2C bus
+
+  // peripheral clock in MHz. I2C requires >=1MHz (standard) or >=4MHz (fast mode)
+  if (fMaster < 1000000L)
+    return(0);
+  freq = (uint8_t) (fMaster / 1000000L);
+  if ((freq < 4) && (speed > I2C_SPEED_STANDARD))
+    speed = I2C_SPEED_STANDARD;
+  if (speed > I2C_SPEED_FAST)
+    speed = I2C_SPEED_FAST;
+  if (speed == 0)
+    speed = 1;
+
+  // standard mode: t_high = t_low = CCR/fMaster. Round CCR up to not exceed speed
+  if (speed <= I2C_SPEED_STANDARD) {
+    ccr = (fMaster + 2*speed - 1) / (2*speed);
+    if (ccr < 4)
+      ccr = 4;
+    if (ccr > 0x0FFF)
+      ccr = 0x0FFF;
+    speed = fMaster / (2*ccr);
+  }
+
+  // fast mode: t_low/t_high = 2 (DUTY=0) or 16/9 (DUTY=1). Use variant with higher speed
+  else {
+    fs  = 1;
+    ccr = (fMaster + 3*speed - 1) / (3*speed);
+    ccr2 = (fMaster + 25*speed - 1) / (25*speed);
+    if (ccr2 < 1)
+      ccr2 = 1;
+    speed2 = fMaster / (25*ccr2);
+    speed  = fMaster / (3*ccr);
+    if (speed2 > speed) {
+      duty  = 1;
+      ccr   = ccr2;
+      speed = speed2;
+    }
+  }
+
+  // set clock registers
   I2C.CR2.reg.ACK       = 1;        // enable ACK on address match
-  I2C.FREQR.reg.FREQ    = 16;       // peripheral clock = 16MHz (f=val*1MHz)
+  I2C.FREQR.reg.FREQ    = freq;     // peripheral clock [MHz]
   I2C.OARH.reg.ADDCONF  = 1;        // set 7b addressing mode
   I2C.OARL.reg.ADD      = 0x04;     // set own 7b addr to 0x04
   I2C.SR1.byte          = 0x00;     // clear status registers
   I2C.SR2.byte          = 0x00;
   I2C.SR3.byte          = 0x00;
-  I2C.CCRL.reg.CCR      = 0x50;     // BR = 100kBaud (t_low = t_high = 80/16MHz)
-  I2C.CCRH.byte         = 0x00;     // I2C standard mode
-  I2C.TRISER.reg.TRISE  = 0x04;     // t_rise<250ns (<300ns for display driver)
+  I2C.CCRL.byte         = (uint8_t) ccr;
+  I2C.CCRH.byte         = (uint8_t) ((fs << 7) | (duty << 6) | ((uint8_t) (ccr >> 8) & 0x0F));
+  if (fs)
+    I2C.TRISER.reg.TRISE = (uint8_t) (((uint16_t) freq * 3) / 10 + 1);   // t_rise<300ns
+  else
+    I2C.TRISER.reg.TRISE = freq + 1;                                      // t_rise<1000ns
   I2C.CR1.reg.PE        = 1;        // enable I2C module with broadcast receive disabled
 
+  // return actual SCL frequency
+  return(speed);
+
+} // i2c_config
+
+
+
+/**
+  \fn uint32_t i2c_begin(uint32_t speed)
+   
+  \brief configure I2C bus with given speed
+
+  \param[in]  speed   SCL frequency [Hz], max. 400kHz (see I2C_SPEED_STANDARD, I2C_SPEED_FAST)
+
+  \return actual SCL frequency [Hz] (<= speed). 0 if master clock <1MHz
+
+  configure I2C bus as master, see i2c_config(). Speed is stored and restored
+  by i2c_init() on errors. Queued transactions are aborted with status
+  I2C_ERR_ABORT and their callbacks are called after re-configuration
+*/
+uint32_t i2c_begin(uint32_t speed) {
+
+  #if defined(USE_I2C_QUEUE)
+    i2c_trans_t   *pAbort;
+  #endif
+
+  // store requested speed for re-init via i2c_init()
+  m_i2c_speed = speed;
+
+  // detach interrupt driven transactions
+  #if defined(USE_I2C_QUEUE)
+    I2C.ITR.byte = m_i2c_itr = 0x00;
+    pAbort = g_i2c_pQueue;
+    g_i2c_pQueue = NULL;
+  #endif
+
+  // configure I2C module
+  speed = i2c_config(speed);
+
+  // finish aborted transactions
+  #if defined(USE_I2C_QUEUE)
+    i2c_abortQueue(pAbort, I2C_ERR_ABORT);
+  #endif
+
+  return(speed);
+
+} // i2c_begin
+
+
+
+/**
+  \fn void i2c_init(void)
+   
+  \brief configure I2C bus
+
+  configure I2C bus as master with speed of last i2c_begin(), default 100kHz.
+  Is also called to reset the I2C bus after a timeout
+*/
+void i2c_init() {
+
+  i2c_begin(m_i2c_speed);
+
 } // i2c_init
 
 
 
+/**
+  \fn uint8_t i2c_recover(void)
+   
+  \brief recover stuck I2C bus
+
+  \return error code (I2C_OK or I2C_ERR_STUCK)
+
+  recover I2C bus after a slave was interrupted during a read and holds SDA low.
+  Disable I2C module and clock SCL via GPIO up to 9 times until slave releases SDA,
+  then generate a stop condition. Finally reset and re-init I2C module, which also
+  clears a stuck BUSY flag. Takes ~100us. Note: aborts queued transactions (see i2c_begin())
+*/
+uint8_t i2c_recover() {
+
+  uint8_t   i, err = I2C_OK;
+
+  // release pins from I2C module and set SCL & SDA high (open-drain)
+  I2C.CR1.reg.PE = 0;
+  pinHigh(&PORT_E, 1);
+  pinHigh(&PORT_E, 2);
+  pinMode(&PORT_E, 1, OUTPUT_OPENDRAIN);
+  pinMode(&PORT_E, 2, OUTPUT_OPENDRAIN);
+  sw_delayMicroseconds(5);
+
+  // SDA low -> clock out remaining bits (max. 8 data + ACK) at ~100kHz
+  for (i=0; (i<9) && (!pinRead(&PORT_E, 2)); i++) {
+    pinLow(&PORT_E, 1);
+    sw_delayMicroseconds(5);
+    pinHigh(&PORT_E, 1);
+    sw_delayMicroseconds(5);
+  }
+
+  // generate stop condition: SDA low->high while SCL high
+  pinLow(&PORT_E, 1);
+  sw_delayMicroseconds(5);
+  pinLow(&PORT_E, 2);
+  sw_delayMicroseconds(5);
+  pinHigh(&PORT_E, 1);
+  sw_delayMicroseconds(5);
+  pinHigh(&PORT_E, 2);
+  sw_delayMicroseconds(5);
+
+  // SDA or SCL still low -> recovery failed
+  if ((!pinRead(&PORT_E, 1)) || (!pinRead(&PORT_E, 2)))
+    err = I2C_ERR_STUCK;
+
+  // reset I2C module (clears BUSY flag) and re-init
+  I2C.CR2.reg.SWRST = 1;
+  I2C.CR2.reg.SWRST = 0;
+  i2c_init();
+
+  // update statistics
+  if (g_i2c_stats.numRecover != 0xFFFF)
+    g_i2c_stats.numRecover++;
+  i2c_countError(err);
+
+  return(err);
+
+} // i2c_recover
+
+
+
+/**
+  \fn void i2c_clearStats(void)
+   
+  \brief reset error statistics
+
+  reset all error counters and number of bus recoveries
+*/
+void i2c_clearStats() {
+
+  uint8_t   i;
+
+  for (i=0; i<I2C_NUM_ERR; i++)
+    g_i2c_stats.err[i] = 0;
+  g_i2c_stats.numRecover = 0;
+
+} // i2c_clearStats
+
+
+
 /**
   \fn uint8_t i2c_waitFree(void)
    
@@ -75,10 +704,9 @@ uint8_t i2c_waitFree() {
   countTimeout = 10000;                           // ~1.1us/inc -> ~10ms
   while ((I2C_BUSY) && (countTimeout--));
  
-  // on I2C timeout return error
+  // on I2C timeout recover bus and return error
   if (I2C_BUSY) {
-    i2c_init();
-    return(1);
+    return(i2c_timeout());
   }
   
   // return success
@@ -106,10 +734,9 @@ uint8_t i2c_start() {
   countTimeout = 10000;                           // ~1.1us/inc -> ~10ms
   while ((!I2C.SR1.reg.SB) && (countTimeout--));
  
-  // on I2C timeout return error
+  // on I2C timeout recover bus and return error
   if (!I2C.SR1.reg.SB) {
-    i2c_init();
-    return(1);
+    return(i2c_timeout());
   }
 
   // return success
@@ -126,21 +753,23 @@ uint8_t i2c_start() {
 
   \return error code (0=ok; 1=timeout)
 
-  generate I2C stop condition with timeout 
+  generate I2C stop condition with timeout. If the stop condition was
+  already requested (e.g. by i2c_request()) or the interface is no
+  master anymore (arbitration lost), only wait until the bus is released
 */
 uint8_t i2c_stop() {
 
   uint16_t  countTimeout;     // use counter for timeout to minimize dependencies
 
-  // generate stop condition with timeout
-  I2C.CR2.reg.STOP = 1;
+  // generate stop condition with timeout. Don't request a 2nd stop
+  if ((I2C.SR3.reg.MSL) && (!I2C.CR2.reg.STOP))
+    I2C.CR2.reg.STOP = 1;
   countTimeout = 10000;                           // ~1.1us/inc -> ~10ms
   while ((I2C.SR3.reg.MSL) && (countTimeout--));
  
-  // on I2C timeout set error flag
+  // on I2C timeout recover bus and return error
   if (I2C.SR3.reg.MSL) {
-    i2c_init();
-    return(1);
+    return(i2c_timeout());
   }
   
   // return success
@@ -159,40 +788,16 @@ uint8_t i2c_stop() {
   \param[in]  numTx       number of bytes to send
   \param[in]  bufTx       send buffer
 
-  \return error code (0=ok; 1=timeout)
+  \return error code (I2C_OK or I2C_ERR_xxx)
 
-  write data to I2C slave with frame timeout. Note that no start or 
-  stop condition is generated.
+  write data to I2C slave after i2c_start(). Wait until the last byte is
+  transferred, i.e. also a NACK of the last byte is reported. Note that no
+  start or stop condition is generated, also not on NACK -> always call
+  i2c_stop(). Errors are counted, on timeout the bus is recovered
 */
 uint8_t i2c_send(uint8_t addr, uint8_t numTx, uint8_t *bufTx) {
 
-  uint8_t   i;
-  uint16_t  countTimeout;     // use counter for timeout to minimize dependencies
-
-  // send 7b slave adress [7:1] + write flag (LSB=0)
-  I2C.DR.byte = (uint8_t) ((addr << 1) & ~0x01);       // shift left and set LSB (write=0, read=1)
-  countTimeout = 10000;                                // ~1.1us/inc -> ~10ms
-  while ((!I2C.SR1.reg.ADDR) && (countTimeout--));     // wait until address sent or timeout
-  countTimeout = 10000;                                // ~1.1us/inc -> ~10ms 
-  while ((!I2C.SR3.reg.BUSY) && (countTimeout--));     // seems to be required...???
-  
-  // no I2C timeout -> send data
-  if (countTimeout) {
-    for (i=0; i<numTx; i++) {
-      I2C.DR.byte = bufTx[i];
-      countTimeout = 1000;                             // ~1.1us/inc -> ~1ms 
-      while ((!I2C.SR1.reg.TXE) && (countTimeout--));  // wait until DR buffer empty or timeout
-    }
-  }
- 
-  // on I2C timeout return error
-  else {
-    i2c_init();
-    return(1);
-  }
-
-  // return success
-  return(0);
+  return(i2c_result(addr, i2c_transmit(addr, numTx, bufTx)));
 
 } // i2c_send
 
@@ -207,45 +812,515 @@ uint8_t i2c_send(uint8_t addr, uint8_t numTx, uint8_t *bufTx) {
   \param[in]  numRx       number of bytes to receive
   \param[out] bufRx       receive buffer
 
-  \return error code (0=ok; 1=timeout)
+  \return error code (I2C_OK or I2C_ERR_xxx)
 
-  request data from I2C slave with frame timeout. Note that no start or 
-  stop condition is generated.
+  request data from I2C slave after i2c_start(). The last byte is NACKed,
+  which requires the stop condition to be requested during reception
+  (see RM0016). Afterwards i2c_stop() only waits until it is generated.
+  On NACK no stop condition is generated -> always call i2c_stop().
+  Errors are counted, on timeout the bus is recovered
 */
 uint8_t i2c_request(uint8_t slaveAddr, uint8_t numRx, uint8_t *bufRx) {
 
   uint8_t   i;
-  uint16_t  countTimeout;     // use counter for timeout to minimize dependencies
   
   // init receive buffer
   for (i=0; i<numRx; i++)
     bufRx[i] = 0;
-    
-  // send 7b slave adress [7:1] + read flag (LSB=1)
-  I2C.DR.byte = (uint8_t) ((slaveAddr << 1) | 0x01);   // shift left and set LSB (write=0, read=1)
-  countTimeout = 10000;                                // ~1.1us/inc -> ~10ms
-  while ((!I2C.SR1.reg.ADDR) && (countTimeout--));     // wait until adress sent or timeout
-  countTimeout = 1000;                                 // ~1.1us/inc -> ~1ms 
-  while ((!I2C.SR3.reg.BUSY) && (countTimeout--));     // seems to be required...???
-
-  for (i=0; i<numRx; i++) {
-    countTimeout = 1000;                               // ~1.1us/inc -> ~1ms 
-    while ((!I2C.SR1.reg.RXNE) && (countTimeout--));   // wait until DR buffer not empty or timeout
-    bufRx[i] = I2C.DR.byte;
-  }
- 
-  // on I2C timeout return error
-  if (!countTimeout) {
-    i2c_init();
-    return(1);
-  }
 
-  // return success
-  return(0);
+  // nothing to read
+  if (numRx == 0)
+    return(I2C_OK);
+
+  // read data with ACK, except last byte
+  I2C.CR2.reg.POS = 0;
+  I2C.CR2.reg.ACK = 1;
+  return(i2c_result(slaveAddr, i2c_receive(slaveAddr, numRx, bufRx)));
  
 } // i2c_request
 
 
+/**
+  \fn uint8_t i2c_writeRead(uint8_t addr, uint8_t numTx, uint8_t *bufTx, uint8_t numRx, uint8_t *bufRx)
+   
+  \brief write, then read data via I2C with repeated start
+
+  \param[in]  addr        7b address [6:0] of I2C slave
+  \param[in]  numTx       number of bytes to send (0=read only)
+  \param[in]  bufTx       send buffer, e.g. register address
+  \param[in]  numRx       number of bytes to receive (0=write only)
+  \param[out] bufRx       receive buffer
+
+  \return error code (I2C_OK or I2C_ERR_xxx)
+
+  complete blocking I2C transfer: start, address + write, send data, repeated
+  start, address + read, receive data, stop. In contrast to i2c_send() and
+  i2c_request() start and stop conditions are generated here, i.e. a register
+  read of a sensor is a single call. With numTx=numRx=0 only the address is
+  sent, i.e. check if a slave is present.
+  On NACK a stop condition is generated, on timeout the I2C bus is recovered
+  (see i2c_recover()). Result updates the presence cache (see i2c_isPresent())
+*/
+uint8_t i2c_writeRead(uint8_t addr, uint8_t numTx, uint8_t *bufTx, uint8_t numRx, uint8_t *bufRx) {
+
+  uint8_t   err;
+
+  err = i2c_transferComplete(addr, numTx, bufTx, numRx, bufRx);
+  if (err != I2C_ERR_TIMEOUT)             // timeout is counted by i2c_timeout()
+    i2c_countError(err);
+
+  return(err);
+
+} // i2c_writeRead
+
+
+
+/**
+  \fn uint8_t i2c_probe(uint8_t addr)
+   
+  \brief check if I2C slave is present
+
+  \param[in]  addr        7b address [6:0] of I2C slave
+
+  \return 1=slave acknowledged address, 0=no response or bus error
+
+  send address and check for ACK. Result is stored in the presence cache
+  (see i2c_isPresent()). A missing slave NACKs within one byte time, i.e.
+  no timeout occurs. Missing slaves are not counted as error
+*/
+uint8_t i2c_probe(uint8_t addr) {
+
+  uint8_t   err;
+
+  err = i2c_transferComplete(addr, 0, NULL, 0, NULL);
+  if ((err != I2C_ERR_TIMEOUT) && (err != I2C_ERR_NACK_ADDR))
+    i2c_countError(err);
+
+  return(err == I2C_OK);
+
+} // i2c_probe
+
+
+
+/**
+  \fn uint8_t i2c_scan(void)
+   
+  \brief scan I2C bus for slaves
+
+  \return number of slaves found
+
+  probe all non-reserved 7b addresses (0x08..0x77) and store result in the
+  presence cache (see i2c_isPresent()). Reserved addresses are marked
+  as absent. Takes ~15ms at 100kHz
+*/
+uint8_t i2c_scan() {
+
+  uint8_t   addr, num = 0;
+
+  for (addr=0; addr<128; addr++) {
+    if ((addr < 0x08) || (addr > 0x77))
+      i2c_setPresent(addr, 0);
+    else
+      num += i2c_probe(addr);
+  }
+
+  return(num);
+
+} // i2c_scan
+
+
+#if defined(USE_I2C_QUEUE)
+
+  /**
+    \fn void i2c_setITR(uint8_t mask)
+   
+    \brief set I2C interrupt mask
+
+    \param[in]  mask    new value of register ITR
+
+    set I2C interrupt mask and remember it for restoring after i2c_submit()
+  */
+  static void i2c_setITR(uint8_t mask) {
+
+    m_i2c_itr = mask;
+    I2C.ITR.byte = mask;
+
+  } // i2c_setITR
+
+
+
+  /**
+    \fn void i2c_startNext(void)
+   
+    \brief start next queued transaction
+
+    start transaction at head of queue by requesting a start condition.
+    If a previous transaction requested a stop condition, wait until it
+    is generated, because writing to CR2 meanwhile may generate a 2nd stop.
+    If queue is empty, disable I2C interrupts
+  */
+  static void i2c_startNext(void) {
+
+    i2c_trans_t   *pTrans = g_i2c_pQueue;
+    uint8_t       countTimeout;
+
+    // queue empty -> disable interrupts
+    if (pTrans == NULL) {
+      i2c_setITR(0x00);
+      return;
+    }
+
+    // wait for pending stop condition (<1 SCL period)
+    countTimeout = 255;                             // ~1.1us/inc -> ~0.3ms
+    while ((I2C.CR2.reg.STOP) && (countTimeout--));
+
+    // start watchdog
+    m_i2c_timeStart = millis();
+
+    // write-only, read-only or write-then-read. Nothing to transfer -> write address only (=probe)
+    m_i2c_flagRead = ((pTrans->numTx == 0) && (pTrans->numRx != 0));
+
+    // generate (repeated) start condition. Address is sent in ISR on SB
+    I2C.CR2.reg.POS   = 0;
+    I2C.CR2.reg.ACK   = 1;
+    i2c_setITR(I2C_ITR_EVT);
+    I2C.CR2.reg.START = 1;
+
+  } // i2c_startNext
+
+
+
+  /**
+    \fn void i2c_stopOrRestart(i2c_trans_t *pTrans)
+   
+    \brief end transaction on bus
+
+    \param[in]  pTrans    active transaction
+
+    generate stop condition, unless flag I2C_REPSTART is set and the next
+    transaction is already queued. Then the next start is a repeated start
+  */
+  static void i2c_stopOrRestart(i2c_trans_t *pTrans) {
+
+    if (!((pTrans->flags & I2C_REPSTART) && (pTrans->pNext != NULL)))
+      I2C.CR2.reg.STOP = 1;
+
+  } // i2c_stopOrRestart
+
+
+
+  /**
+    \fn void i2c_finish(uint8_t status)
+   
+    \brief finish active transaction
+
+    \param[in]  status    result, I2C_OK or I2C_ERR_xxx
+
+    remove active transaction from queue, start next transaction and
+    call completion callback of finished transaction.
+    Callback is called last, so it may submit a new transaction
+  */
+  static void i2c_finish(uint8_t status) {
+
+    i2c_trans_t   *pTrans = g_i2c_pQueue;
+
+    // remove from queue and start next
+    g_i2c_pQueue = pTrans->pNext;
+    pTrans->status = status;
+    i2c_countError(status);
+    if (status == I2C_OK)
+      i2c_setPresent(pTrans->addr, 1);
+    else if (status == I2C_ERR_NACK_ADDR)
+      i2c_setPresent(pTrans->addr, 0);
+    i2c_startNext();
+
+    // notify user
+    if (pTrans->pCallback != NULL)
+      pTrans->pCallback(pTrans);
+
+  } // i2c_finish
+
+
+
+  /**
+    \fn void i2c_endWrite(i2c_trans_t *pTrans)
+   
+    \brief write phase finished
+
+    \param[in]  pTrans    active transaction
+
+    after last byte is sent either start read phase with repeated start,
+    or finish transaction
+  */
+  static void i2c_endWrite(i2c_trans_t *pTrans) {
+
+    // read follows -> repeated start. Also clears BTF
+    if (pTrans->numRx != 0) {
+      m_i2c_flagRead = 1;
+      I2C.CR2.reg.START = 1;
+    }
+
+    // write only -> done
+    else {
+      i2c_stopOrRestart(pTrans);
+      i2c_finish(I2C_OK);
+    }
+
+  } // i2c_endWrite
+
+
+
+  /**
+    \fn uint8_t i2c_submit(i2c_trans_t *pTrans)
+   
+    \brief add transaction to queue
+
+    \param[in]  pTrans    transaction. Must stay valid until status != I2C_PENDING
+
+    \return error code (0=ok; 1=transaction is already queued)
+
+    add transaction to end of queue and start it if bus is idle. The
+    transaction is processed in the background by the I2C ISR, i.e. this
+    function returns immediately. Check pTrans->status or use pTrans->pCallback
+    for completion. May also be called from a completion callback.
+    Note: don't use blocking I2C functions while the queue is not empty
+  */
+  uint8_t i2c_submit(i2c_trans_t *pTrans) {
+
+    i2c_trans_t   *p;
+
+    // abort hanging transaction
+    i2c_checkQueue();
+
+    // lock out I2C ISR. Interrupt flags stay pending, SCL is stretched meanwhile
+    I2C.ITR.byte = 0x00;
+
+    // don't link transaction twice
+    for (p=g_i2c_pQueue; p!=NULL; p=p->pNext) {
+      if (p == pTrans) {
+        I2C.ITR.byte = m_i2c_itr;
+        return(1);
+      }
+    }
+
+    // append to queue
+    pTrans->status = I2C_PENDING;
+    pTrans->pNext  = NULL;
+    if (g_i2c_pQueue == NULL) {
+      g_i2c_pQueue = pTrans;
+      m_i2c_pTail  = pTrans;
+      i2c_startNext();
+    }
+    else {
+      m_i2c_pTail->pNext = pTrans;
+      m_i2c_pTail        = pTrans;
+      I2C.ITR.byte = m_i2c_itr;
+    }
+
+    // return success
+    return(0);
+
+  } // i2c_submit
+
+
+
+  /**
+    \fn uint8_t i2c_checkQueue(void)
+   
+    \brief queue watchdog
+
+    \return 1 if active transaction was aborted, else 0
+
+    if the active transaction takes longer than I2C_QUEUE_TIMEOUT, e.g. a slave
+    stretches SCL or an event was lost, abort it with I2C_ERR_TIMEOUT, recover
+    the bus and continue with the next queued transaction. Is called by
+    i2c_submit() and i2c_isIdleQueue(). Call it also when polling pTrans->status
+  */
+  uint8_t i2c_checkQueue(void) {
+
+    i2c_trans_t   *pTrans, *pRest;
+
+    // lock out I2C ISR
+    I2C.ITR.byte = 0x00;
+
+    // queue empty or no timeout -> done
+    pTrans = g_i2c_pQueue;
+    if ((pTrans == NULL) || ((uint32_t) (millis() - m_i2c_timeStart) < I2C_QUEUE_TIMEOUT)) {
+      I2C.ITR.byte = m_i2c_itr;
+      return(0);
+    }
+
+    // detach active transaction and remaining queue, then recover bus
+    pRest = pTrans->pNext;
+    pTrans->pNext = NULL;
+    g_i2c_pQueue = NULL;
+    i2c_recover();
+
+    // restart remaining queue. Tail is unchanged
+    if (pRest != NULL) {
+      g_i2c_pQueue = pRest;
+      i2c_startNext();
+    }
+
+    // finish active transaction
+    i2c_abortQueue(pTrans, I2C_ERR_TIMEOUT);
+
+    return(1);
+
+  } // i2c_checkQueue
+
+
+
+  /**
+    \fn void I2C_ISR(void)
+   
+    \brief I2C interrupt service routine
+
+    state machine for queued master transactions. Reception of the last
+    bytes follows the reference manual (RM0016), i.e. 1 byte: NACK before
+    clearing ADDR, 2 bytes: POS, >2 bytes: last 3 bytes via BTF.
+    On error the transaction is aborted and the next one is started
+  */
+  ISR_HANDLER(I2C_ISR, __I2C_VECTOR__) {
+
+    i2c_trans_t   *pTrans = g_i2c_pQueue;
+    uint8_t       sr1, sr2, rem;
+
+    // no active transaction -> disable interrupts
+    if (pTrans == NULL) {
+      I2C.SR2.byte = 0x00;
+      i2c_setITR(0x00);
+      return;
+    }
+
+    // error: bus error (BERR), arbitration lost (ARLO), NACK (AF) or overrun (OVR)
+    sr2 = I2C.SR2.byte;
+    if (sr2 & 0x0F) {
+      I2C.SR2.byte = 0x00;
+      if (sr2 & 0x02)                   // arbitration lost -> interface is slave already, no stop
+        rem = I2C_ERR_ARLO;
+      else {
+        I2C.CR2.reg.STOP = 1;
+        if (sr2 & 0x04)
+          rem = (m_i2c_flagAddr) ? I2C_ERR_NACK_ADDR : I2C_ERR_NACK_DATA;
+        else
+          rem = I2C_ERR_BUS;
+      }
+      i2c_finish(rem);
+      return;
+    }
+
+    // read SR1 for below flag checks
+    sr1 = I2C.SR1.byte;
+
+    // start condition generated (SB) -> send address + R/W flag. Clears SB
+    if (sr1 & 0x01) {
+      m_i2c_flagAddr = 1;
+      m_i2c_idx = 0;
+      I2C.DR.byte = (uint8_t) ((pTrans->addr << 1) | m_i2c_flagRead);
+      return;
+    }
+
+    // address acknowledged (ADDR). Is cleared by reading SR3
+    if (sr1 & 0x02) {
+      m_i2c_flagAddr = 0;
+
+      // write phase -> send data via TXE
+      if (!m_i2c_flagRead) {
+        sr2 = I2C.SR3.byte;
+        if (pTrans->numTx != 0)
+          i2c_setITR(I2C_ITR_BUF);
+        else
+          i2c_endWrite(pTrans);
+      }
+
+      // read 1 byte -> NACK before clearing ADDR, stop after, receive via RXNE
+      else if (pTrans->numRx == 1) {
+        I2C.CR2.reg.ACK = 0;
+        sr2 = I2C.SR3.byte;
+        i2c_stopOrRestart(pTrans);
+        i2c_setITR(I2C_ITR_BUF);
+      }
+
+      // read 2 bytes -> NACK applies to 2nd byte (POS), receive both via BTF
+      else if (pTrans->numRx == 2) {
+        I2C.CR2.reg.POS = 1;
+        sr2 = I2C.SR3.byte;
+        I2C.CR2.reg.ACK = 0;
+      }
+
+      // read >2 bytes -> receive via RXNE until last 3 bytes
+      else {
+        sr2 = I2C.SR3.byte;
+        if (pTrans->numRx > 3)
+          i2c_setITR(I2C_ITR_BUF);
+      }
+
+      return;
+
+    } // ADDR
+
+    // write phase
+    if (!m_i2c_flagRead) {
+
+      // send next byte. After last byte wait for BTF
+      if (m_i2c_idx < pTrans->numTx) {
+        if (sr1 & 0x80) {
+          I2C.DR.byte = pTrans->bufTx[m_i2c_idx++];
+          if (m_i2c_idx == pTrans->numTx)
+            i2c_setITR(I2C_ITR_EVT);
+        }
+      }
+
+      // last byte sent (BTF)
+      else if (sr1 & 0x04)
+        i2c_endWrite(pTrans);
+
+      return;
+
+    } // write phase
+
+    // read phase
+    rem = pTrans->numRx - m_i2c_idx;
+
+    // single byte received (RXNE)
+    if (rem == 1) {
+      if (sr1 & 0x40) {
+        pTrans->bufRx[m_i2c_idx] = I2C.DR.byte;
+        i2c_finish(I2C_OK);
+      }
+    }
+
+    // receive via RXNE. Wait for BTF for last 3 bytes
+    else if (rem > 3) {
+      if (sr1 & 0x40) {
+        pTrans->bufRx[m_i2c_idx++] = I2C.DR.byte;
+        if (rem == 4)
+          i2c_setITR(I2C_ITR_EVT);
+      }
+    }
+
+    // last 3 bytes: byte N-2 in DR, N-1 in shift register (BTF) -> NACK last byte
+    else if (sr1 & 0x04) {
+      if (rem == 3) {
+        I2C.CR2.reg.ACK = 0;
+        pTrans->bufRx[m_i2c_idx++] = I2C.DR.byte;
+      }
+
+      // last 2 bytes: byte N-1 in DR, N in shift register (BTF) -> stop and read both
+      else {
+        i2c_stopOrRestart(pTrans);
+        pTrans->bufRx[m_i2c_idx++] = I2C.DR.byte;
+        pTrans->bufRx[m_i2c_idx++] = I2C.DR.byte;
+        i2c_finish(I2C_OK);
+      }
+    }
+
+  } // I2C_ISR
+
+#endif // USE_I2C_QUEUE
+
+
 /*-----------------------------------------------------------------------------
     END OF MODULE
 -----------------------------------------------------------------------------*/
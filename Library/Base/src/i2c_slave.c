@@ -0,0 +1,253 @@
+/**
+  \file i2c_slave.c
+
+  \author G. Icking-Konert
+  \date 2026-10-17
+  \version 0.1
+
+  \brief implementation of I2C slave with register map
+
+  implementation of interrupt driven I2C slave with RAM register map
+  and auto-increment. For details see i2c_slave.h
+*/
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "stm8as.h"
+#include "config.h"
+#include "i2c_slave.h"
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF MODULE VARIABLES
+-----------------------------------------------------------------------------*/
+
+// I2C interrupt enable masks (register ITR)
+#define I2C_ITR_EVT   0x03                                  ///< error + event interrupts (ADDR, STOPF)
+#define I2C_ITR_BUF   0x07                                  ///< additionally buffer interrupts (TXE, RXNE)
+
+static uint8_t      *m_i2c_slave_regs;                      ///< register map
+static uint8_t      m_i2c_slave_size;                       ///< size of register map [B]
+static void         (*m_i2c_slave_pWrite)(uint8_t, uint8_t); ///< called after master wrote registers
+static void         (*m_i2c_slave_pRead)(uint8_t);          ///< called before master reads registers
+static uint8_t      m_i2c_slave_itr;                        ///< I2C interrupt mask requested by ISR
+static uint8_t      m_i2c_slave_reg;                        ///< current register address
+static uint8_t      m_i2c_slave_regStart;                   ///< first register written by master
+static uint8_t      m_i2c_slave_numWrite;                   ///< number of registers written by master
+static uint8_t      m_i2c_slave_flagAddr;                   ///< next received byte is register address
+static uint8_t      m_i2c_slave_flagTx;                     ///< master reads from slave
+
+
+/*----------------------------------------------------------
+    MODULE FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn void i2c_slave_setITR(uint8_t mask)
+
+  \brief set I2C interrupt mask
+
+  \param[in]  mask    new value of register ITR
+
+  set I2C interrupt mask and remember it for i2c_slave_unlock()
+*/
+static void i2c_slave_setITR(uint8_t mask) {
+
+  m_i2c_slave_itr = mask;
+  I2C.ITR.byte = mask;
+
+} // i2c_slave_setITR
+
+
+
+/**
+  \fn void i2c_slave_endWrite(void)
+
+  \brief end of master write
+
+  notify user about registers written by master, if any
+*/
+static void i2c_slave_endWrite(void) {
+
+  if ((m_i2c_slave_numWrite != 0) && (m_i2c_slave_pWrite != NULL))
+    m_i2c_slave_pWrite(m_i2c_slave_regStart, m_i2c_slave_numWrite);
+  m_i2c_slave_numWrite = 0;
+
+} // i2c_slave_endWrite
+
+
+
+/*----------------------------------------------------------
+    GLOBAL FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn void i2c_slave_begin(uint8_t addr, uint8_t size, uint8_t *regs, void (*pWrite)(uint8_t, uint8_t), void (*pRead)(uint8_t))
+
+  \brief configure I2C as slave
+
+  \param[in]  addr      own 7b address [6:0]
+  \param[in]  size      size of register map [B]
+  \param[in]  regs      register map
+  \param[in]  pWrite    called from ISR with first register and number of registers written by master. NULL for none
+  \param[in]  pRead     called from ISR with current register before master reads. NULL for none
+
+  configure I2C pins and module (see i2c_begin()), set own address and
+  enable I2C interrupt. Clock stretching is enabled
+*/
+void i2c_slave_begin(uint8_t addr, uint8_t size, uint8_t *regs, void (*pWrite)(uint8_t, uint8_t), void (*pRead)(uint8_t)) {
+
+  // init module. Slave requires FREQR for timing
+  i2c_slave_setITR(0x00);
+  i2c_begin(I2C_SPEED_STANDARD);
+
+  // store register map and callbacks
+  m_i2c_slave_regs     = regs;
+  m_i2c_slave_size     = size;
+  m_i2c_slave_pWrite   = pWrite;
+  m_i2c_slave_pRead    = pRead;
+  m_i2c_slave_reg      = 0;
+  m_i2c_slave_numWrite = 0;
+  m_i2c_slave_flagAddr = 0;
+  m_i2c_slave_flagTx   = 0;
+
+  // set own address, ACK on address match and enable interrupts
+  I2C.OARL.reg.ADD = addr;
+  I2C.CR2.reg.ACK  = 1;
+  i2c_slave_setITR(I2C_ITR_BUF);
+
+} // i2c_slave_begin
+
+
+
+/**
+  \fn void i2c_slave_end(void)
+
+  \brief disable I2C slave
+
+  disable I2C interrupts and module, i.e. slave doesn't respond anymore
+*/
+void i2c_slave_end() {
+
+  i2c_slave_setITR(0x00);
+  I2C.CR1.reg.PE = 0;
+
+} // i2c_slave_end
+
+
+
+/**
+  \fn void i2c_slave_lock(void)
+
+  \brief block master access
+
+  disable I2C interrupts, e.g. to update multi-byte registers consistently.
+  Master access is delayed via clock stretching until i2c_slave_unlock()
+*/
+void i2c_slave_lock() {
+
+  I2C.ITR.byte = 0x00;
+
+} // i2c_slave_lock
+
+
+
+/**
+  \fn void i2c_slave_unlock(void)
+
+  \brief allow master access
+
+  restore I2C interrupts after i2c_slave_lock()
+*/
+void i2c_slave_unlock() {
+
+  I2C.ITR.byte = m_i2c_slave_itr;
+
+} // i2c_slave_unlock
+
+
+
+/**
+  \fn void I2C_ISR(void)
+
+  \brief I2C interrupt service routine
+
+  state machine for slave with register map. Each event is served in O(1),
+  SCL is stretched until then
+*/
+ISR_HANDLER(I2C_ISR, __I2C_VECTOR__) {
+
+  uint8_t   sr1, sr2;
+
+  // error: NACK (AF) marks end of master read. Bus error (BERR) or overrun (OVR) is ignored
+  sr2 = I2C.SR2.byte;
+  if (sr2 & 0x0F) {
+    I2C.SR2.byte = 0x00;
+    if ((sr2 & 0x04) && (m_i2c_slave_flagTx)) {
+      m_i2c_slave_flagTx = 0;
+      m_i2c_slave_reg--;                    // last byte loaded to DR was not read by master
+      i2c_slave_setITR(I2C_ITR_EVT);        // ignore TXE until next address match
+    }
+    return;
+  }
+
+  // read SR1 for below flag checks
+  sr1 = I2C.SR1.byte;
+
+  // address matched (ADDR). Is cleared by reading SR3
+  if (sr1 & 0x02) {
+
+    // repeated start after master write -> notify user
+    i2c_slave_endWrite();
+
+    // master reads (TRA=1) -> update map via callback. Else 1st byte is register address
+    m_i2c_slave_flagTx = I2C.SR3.reg.TRA;
+    if (m_i2c_slave_flagTx) {
+      if (m_i2c_slave_pRead != NULL)
+        m_i2c_slave_pRead(m_i2c_slave_reg);
+    }
+    else
+      m_i2c_slave_flagAddr = 1;
+    i2c_slave_setITR(I2C_ITR_BUF);
+    return;
+
+  } // ADDR
+
+  // byte received (RXNE) -> register address or data
+  if (sr1 & 0x40) {
+    sr2 = I2C.DR.byte;
+    if (m_i2c_slave_flagAddr) {
+      m_i2c_slave_flagAddr = 0;
+      m_i2c_slave_reg      = sr2;
+      m_i2c_slave_regStart = sr2;
+    }
+    else {
+      if (m_i2c_slave_reg < m_i2c_slave_size) {
+        m_i2c_slave_regs[m_i2c_slave_reg] = sr2;
+        m_i2c_slave_numWrite++;
+      }
+      m_i2c_slave_reg++;
+    }
+  }
+
+  // send buffer empty (TXE) -> send next register
+  if ((sr1 & 0x80) && (m_i2c_slave_flagTx)) {
+    if (m_i2c_slave_reg < m_i2c_slave_size)
+      I2C.DR.byte = m_i2c_slave_regs[m_i2c_slave_reg];
+    else
+      I2C.DR.byte = 0xFF;
+    m_i2c_slave_reg++;
+  }
+
+  // stop condition detected (STOPF). Is cleared by writing CR2
+  if (sr1 & 0x10) {
+    I2C.CR2.reg.ACK = 1;
+    i2c_slave_endWrite();
+  }
+
+} // I2C_ISR
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
@@ -18,9 +18,6 @@
 #include "stm8as.h"     // STM8 registers etc.
 #include "misc.h"
 #include <stdlib.h>
-#if defined(USE_FTOA)
-  #include <stdio.h>
-#endif
 
 
 /*----------------------------------------------------------
@@ -52,56 +49,127 @@ uint8_t log2(uint32_t arg) {
 
 
 
-/**
-  \fn void floatToString(float f, uint8_t digits)
+#if defined(USE_FTOA)
+
+  /**
+    \fn char *uintToDigits(char *p, uint32_t val, uint8_t num)
    
-  \brief convert float to ascii string
+    \brief convert unsigned number to decimal digits backwards
   
-  \param[out] buf     string to convert into
-  \param[in]  value   floating number to convert
-  \param[in]  digits  number of digits
+    \param[in]  p       end of buffer. Digits are stored backwards from here
+    \param[in]  val     number to convert
+    \param[in]  num     min. number of digits (leading zeros)
   
-  \return buf
+    \return pointer to first digit
 
-  Convert a floating point number to C-terminated string.
-  Can be used e.g. for printing floats via printf(), which
-  is not supported natively by SDCC.
-  Does not support scientific notation, e.g. 1.2e5.
-*/
-#if defined(USE_FTOA)
+    helper for floatToString(). Uses 32-bit division only
+    while value doesn't fit into 16 bit
+  */
+  static char *uintToDigits(char *p, uint32_t val, uint8_t num) {
+
+    uint16_t  val16;
+
+    // upper digits with 32-bit division
+    while (val > 0xFFFF) {
+      *(--p) = '0' + (uint8_t) (val % 10);
+      val /= 10;
+      if (num)
+        num--;
+    }
+
+    // remaining digits with 16-bit division
+    val16 = (uint16_t) val;
+    do {
+      *(--p) = '0' + (uint8_t) (val16 % 10);
+      val16 /= 10;
+      if (num)
+        num--;
+    } while ((val16) || (num));
+
+    return(p);
+
+  } // uintToDigits
+
+
+
+  /**
+    \fn char *floatToString(char *buf, float f, uint8_t digits)
+   
+    \brief convert float to ascii string
+  
+    \param[out] buf     string to convert into. Size >= 13+digits
+    \param[in]  f       floating number to convert
+    \param[in]  digits  number of decimals (max. 6)
+  
+    \return buf
+
+    Convert a floating point number to C-terminated string.
+    Can be used e.g. for printing floats via printf(), which
+    is not supported natively by SDCC.
+    Integer and fraction are converted separately to fixed point
+    with rounding, then digits are extracted directly, i.e. w/o sprintf().
+    A rounded result of 0 is printed without sign. Values >=2^32, inf
+    and nan are printed as "ovf".
+    Does not support scientific notation, e.g. 1.2e5.
+  */
   char *floatToString(char *buf, float f, uint8_t digits) {
   
-    uint8_t   i;
-    int32_t   scale;
-    int32_t   pre, post;
-    char      fmt[15];
+    static const uint32_t scale[] = {1L, 10L, 100L, 1000L, 10000L, 100000L, 1000000L};
+    char      tmp[20];
+    char      *p;
+    uint8_t   flagNeg;
+    uint32_t  pre, post;
   
     // clip digits to 6
     if (digits > 6)
       digits = 6;
 
-    // convert digits to scale for base 10
-    scale = 1;
-    for (i=0; i<digits; i++)
-      scale *= 10;
- 
-    // separate integer and fractional numbers
-    pre  = (long) f;
-    post = (long) ((f - (float) pre) * (float) scale);
-  
-    // required for -0.x and trailing 0
-    if (f < 0.0)
-      sprintf(fmt, "-%%d.%%0%dd", (int) digits);
-    else
-      sprintf(fmt,  "%%d.%%0%dd", (int) digits);
-
-    // convert ints to string
-    sprintf(buf, fmt, abs((int) pre), abs((int) post));
+    // separate sign
+    flagNeg = 0;
+    if (f < 0.0) {
+      flagNeg = 1;
+      f = -f;
+    }
+
+    // not a number or integer part exceeds 32 bit (also catches inf)
+    if (!(f < 4294967040.0)) {
+      buf[0] = 'o'; buf[1] = 'v'; buf[2] = 'f'; buf[3] = '\0';
+      return(buf);
+    }
+
+    // separate integer and fractional part. Fraction is exact in float
+    pre  = (uint32_t) f;
+    post = (uint32_t) ((f - (float) pre) * (float) scale[digits] + 0.5);
+
+    // fraction rounded up to 1 -> carry to integer part
+    if (post >= scale[digits]) {
+      post -= scale[digits];
+      pre++;
+    }
+
+    // -0.000 -> 0.000
+    if ((pre == 0) && (post == 0))
+      flagNeg = 0;
+
+    // extract digits backwards: fraction with leading zeros, point, integer part
+    p = tmp + sizeof(tmp) - 1;
+    *p = '\0';
+    if (digits) {
+      p = uintToDigits(p, post, digits);
+      *(--p) = '.';
+    }
+    p = uintToDigits(p, pre, 1);
+    if (flagNeg)
+      *(--p) = '-';
+
+    // copy to result
+    for (digits=0; (buf[digits] = p[digits]) != '\0'; digits++);
     
     // return buf
     return(buf);
 
   } // floatToString
+
 #endif // USE_FTOA
 
 /*-----------------------------------------------------------------------------
@@ -0,0 +1,277 @@
+/**
+  \file print.c
+
+  \author G. Icking-Konert
+  \date 2026-10-17
+  \version 0.1
+
+  \brief implementation of lightweight formatted output
+
+  implementation of a small, integer-only replacement for printf().
+  Values fitting into 16 bit are converted with 16-bit arithmetic, which
+  uses the STM8 hardware divider. For supported formats see print.h
+*/
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdarg.h>
+#include "stm8as.h"
+#include "config.h"
+#include "print.h"
+
+
+/*----------------------------------------------------------
+    MODULE FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn uint8_t print_toDigits(char *end, uint32_t val, uint8_t base, char hex)
+
+  \brief convert unsigned number to digits
+
+  \param[in]  end     end of buffer. Digits are stored backwards from here
+  \param[in]  val     number to convert
+  \param[in]  base    10 or 16
+  \param[in]  hex     'a' or 'A' for hex digits
+
+  \return  number of digits (>=1)
+
+  convert unsigned number to ASCII digits. Only use 32-bit division
+  while value doesn't fit into 16 bit. Base 16 uses shifts only
+*/
+static uint8_t print_toDigits(char *end, uint32_t val, uint8_t base, char hex) {
+
+  char      *p = end;
+  uint16_t  val16;
+  uint8_t   d;
+
+  // hexadecimal: shift & mask, no division
+  if (base == 16) {
+    do {
+      d = (uint8_t) val & 0x0F;
+      *(--p) = (d < 10) ? ('0' + d) : (hex - 10 + d);
+      val >>= 4;
+    } while (val);
+    return((uint8_t) (end - p));
+  }
+
+  // decimal: 32-bit division only for upper digits
+  while (val > 0xFFFF) {
+    *(--p) = '0' + (uint8_t) (val % 10);
+    val /= 10;
+  }
+
+  // decimal: remaining digits with 16-bit division
+  val16 = (uint16_t) val;
+  do {
+    *(--p) = '0' + (uint8_t) (val16 % 10);
+    val16 /= 10;
+  } while (val16);
+
+  return((uint8_t) (end - p));
+
+} // print_toDigits
+
+
+
+/**
+  \fn void print_repeat(char c, uint8_t num)
+
+  \brief output character repeatedly
+
+  \param[in]  c       character to output
+  \param[in]  num     number of repetitions
+*/
+static void print_repeat(char c, uint8_t num) {
+
+  while (num--)
+    putchar(c);
+
+} // print_repeat
+
+
+
+/*----------------------------------------------------------
+    GLOBAL FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn void print(const char *fmt, ...)
+
+  \brief formatted output via putchar()
+
+  \param[in]  fmt     format string, see print.h
+  \param[in]  ...     values to print
+
+  lightweight replacement for printf() without float support.
+  Additionally supports fixed point output via %q.
+  Output is sent via putchar()
+*/
+void print(const char *fmt, ...) {
+
+  va_list   ap;
+  char      c, pad, hex;
+  char      buf[10];          // 32-bit in decimal has max. 10 digits
+  char      *p;
+  uint8_t   width, prec, flagLong, flagNeg, num, len, base;
+  uint32_t  val;
+
+  va_start(ap, fmt);
+
+  while ((c = *fmt++) != '\0') {
+
+    // copy plain characters
+    if (c != '%') {
+      putchar(c);
+      continue;
+    }
+
+    // zero padding
+    pad = ' ';
+    if (*fmt == '0') {
+      pad = '0';
+      fmt++;
+    }
+
+    // field width
+    width = 0;
+    while ((*fmt >= '0') && (*fmt <= '9'))
+      width = width * 10 + (*fmt++ - '0');
+
+    // precision (only for %q)
+    prec = PRINT_Q_DEFAULT;
+    if (*fmt == '.') {
+      fmt++;
+      prec = 0;
+      while ((*fmt >= '0') && (*fmt <= '9'))
+        prec = prec * 10 + (*fmt++ - '0');
+      if (prec > 9)
+        prec = 9;
+    }
+
+    // 32-bit argument
+    flagLong = 0;
+    if (*fmt == 'l') {
+      flagLong = 1;
+      fmt++;
+    }
+
+    // conversion
+    c = *fmt++;
+    flagNeg = 0;
+    base = 10;
+    hex = 'a';
+    switch (c) {
+
+      // single character
+      case 'c':
+        putchar((char) va_arg(ap, int));
+        continue;
+
+      // string
+      case 's':
+        for (p = va_arg(ap, char*); *p; p++)
+          putchar(*p);
+        continue;
+
+      // signed decimal or fixed point
+      case 'd':
+      case 'i':
+      case 'q':
+        if (flagLong)
+          val = (uint32_t) va_arg(ap, int32_t);
+        else
+          val = (uint32_t) (int32_t) va_arg(ap, int);
+        if ((int32_t) val < 0) {
+          flagNeg = 1;
+          val = -val;
+        }
+        break;
+
+      // hexadecimal
+      case 'X':
+        hex = 'A';
+        // fall through
+      case 'x':
+        base = 16;
+        // fall through
+
+      // unsigned decimal
+      case 'u':
+        if (flagLong)
+          val = va_arg(ap, uint32_t);
+        else
+          val = (uint16_t) va_arg(ap, unsigned int);
+        break;
+
+      // end of string after '%'
+      case '\0':
+        fmt--;
+        continue;
+
+      // '%' or unknown conversion -> print as is
+      default:
+        putchar(c);
+        continue;
+
+    } // switch (c)
+
+    // convert number
+    num = print_toDigits(buf+sizeof(buf), val, base, hex);
+    p = buf + sizeof(buf) - num;
+
+    // get total length for padding
+    len = num + flagNeg;
+    if (c == 'q') {
+      if (num <= prec)
+        len += prec + 1 - num;          // leading "0.00"
+      if (prec)
+        len++;                          // decimal point
+    }
+
+    // sign and padding. With zero padding sign comes first
+    if (width > len) {
+      if (pad == '0') {
+        if (flagNeg)
+          putchar('-');
+        flagNeg = 0;
+      }
+      print_repeat(pad, width - len);
+    }
+    if (flagNeg)
+      putchar('-');
+
+    // integer -> print digits
+    if (c != 'q') {
+      while (num--)
+        putchar(*p++);
+      continue;
+    }
+
+    // fixed point -> leading zeros and decimal point
+    if (num <= prec) {
+      putchar('0');
+      if (prec)
+        putchar('.');
+      print_repeat('0', prec - num);
+    }
+    else {
+      for (num -= prec; num; num--)
+        putchar(*p++);
+      if (prec)
+        putchar('.');
+    }
+    while (p < buf + sizeof(buf))
+      putchar(*p++);
+
+  } // loop over fmt
+
+  va_end(ap);
+
+} // print
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
@@ -25,6 +25,12 @@
  
 volatile void (*m_putchar_Tx_pFct)(uint8_t) = putchar_Default;   ///< pointer to printf()/putchar() send routine
 
+static uint8_t  (*m_putchar_Try_pFct)(uint8_t);                   ///< buffered mode: non-blocking send routine
+static void     (*m_putchar_Flush_pFct)(void);                    ///< buffered mode: wait until buffer is sent. NULL for none
+static uint8_t  m_putchar_policy;                                 ///< buffered mode: policy for full buffer
+
+volatile uint16_t  g_putchar_overflow = 0;                        ///< number of characters discarded with PUTCHAR_COUNT
+
 
 /*----------------------------------------------------------
     FUNCTIONS
@@ -65,8 +71,79 @@ void putcharAttach(void (*pFct)(uint8_t)) {
 
   // set send function for putchar()
   m_putchar_Tx_pFct = pFct;
+
+  // no buffer to flush
+  m_putchar_Flush_pFct = NULL;
     
 } // putcharAttach
+
+
+
+/**
+  \fn void putchar_Buffered(uint8_t c)
+   
+  \brief buffered putchar() send function
+  
+  \param[in]  c  char to send
+   
+  queue char via non-blocking send function set in putcharAttachBuffered().
+  If buffer is full, apply selected policy
+*/
+static void putchar_Buffered(uint8_t c) {
+
+  // fast path: char fits into buffer
+  if (m_putchar_Try_pFct(c))
+    return;
+
+  // buffer full -> apply policy
+  if (m_putchar_policy == PUTCHAR_BLOCK) {
+    while (!m_putchar_Try_pFct(c));
+  }
+  else if (m_putchar_policy == PUTCHAR_COUNT)
+    g_putchar_overflow++;
+  
+} // putchar_Buffered
+
+
+
+/**
+  \fn void putcharAttachBuffered(uint8_t (*pFct)(uint8_t), void (*pFlush)(void), uint8_t policy)
+   
+  \brief set buffered putchar() send function
+  
+  \param[in]  pFct    non-blocking send function, returns 0 if buffer is full. E.g. UART1_tryWrite
+  \param[in]  pFlush  wait until buffer is sent, e.g. UART1_flush. NULL for none
+  \param[in]  policy  policy for full buffer (PUTCHAR_DROP, PUTCHAR_BLOCK, PUTCHAR_COUNT)
+   
+  set non-blocking send function for putchar(). printf() then only copies to 
+  the buffer, which is sent in background, e.g. by UART1 TXE ISR
+*/
+void putcharAttachBuffered(uint8_t (*pFct)(uint8_t), void (*pFlush)(void), uint8_t policy) {
+
+  // set buffered mode. Change send function last, as putchar() may be called from ISR
+  m_putchar_Try_pFct   = pFct;
+  m_putchar_Flush_pFct = pFlush;
+  m_putchar_policy     = policy;
+  m_putchar_Tx_pFct    = putchar_Buffered;
+    
+} // putcharAttachBuffered
+
+
+
+/**
+  \fn void putchar_flush(void)
+   
+  \brief wait until buffered output is sent
+  
+  wait until output queued via putchar() is sent. Only
+  has an effect in buffered mode, see putcharAttachBuffered()
+*/
+void putchar_flush(void) {
+
+  if (m_putchar_Flush_pFct != NULL)
+    m_putchar_Flush_pFct();
+    
+} // putchar_flush
   
   
   
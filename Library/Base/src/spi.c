@@ -36,6 +36,18 @@
 volatile uint8_t   saved_SPI_CR1[NUM_SPI_SETTINGS];
 volatile uint8_t   saved_SPI_CR2[NUM_SPI_SETTINGS];
 
+// slave selected via spi_select()
+static spi_profile_t  *m_spi_pSelected = NULL;
+
+#if defined(USE_SPI_QUEUE)
+
+  spi_trans_t * volatile  g_spi_pQueue = NULL;    ///< active transfer and head of queue
+  static spi_trans_t      *m_spi_pTail;           ///< last transfer in queue
+  static uint8_t          m_spi_icr;              ///< SPI interrupt mask requested by ISR
+  static uint16_t         m_spi_idx;              ///< number of bytes received in active transfer
+
+#endif // USE_SPI_QUEUE
+
 
 /*----------------------------------------------------------
     FUNCTIONS
@@ -145,20 +157,21 @@ void spi_save_config(uint8_t N) {
   \param[in]  N    index of configuration buffer (must be 0..NUM_SPI_SETTINGS-1)
 
   restore configuration of SPI from buffer N. 
-  Is convenient to switch settings for different SPI slaves
+  Is convenient to switch settings for different SPI slaves. See also spi_select()
   Warning: for speed reasons no range check is performed!
 */
 void spi_restore_config(uint8_t N) {
 
   uint8_t tmp;
   
-  // disable enable status prior to saving
+  // disable SPI prior to restoring (BR, CPOL, CPHA must not change while enabled)
+  while (SPI.SR.reg.BSY);
   tmp = SPI.CR1.reg.SPE;
   SPI.CR1.reg.SPE = 0;
   
-  // buffers for SPI configuration (e.g. for SD card)
-  saved_SPI_CR1[N] = SPI.CR1.byte;
-  saved_SPI_CR2[N] = SPI.CR2.byte;
+  // restore SPI configuration. Saved CR1 has SPE=0
+  SPI.CR2.byte = saved_SPI_CR2[N];
+  SPI.CR1.byte = saved_SPI_CR1[N];
   
   // restore enable status
   SPI.CR1.reg.SPE = tmp;
@@ -166,6 +179,217 @@ void spi_restore_config(uint8_t N) {
 } // spi_restore_config
 
 
+/**
+  \fn void spi_initProfile(spi_profile_t *pProfile, uint8_t type, uint8_t pre, uint8_t order, uint8_t mode, PORT_t *pPortCSN, uint8_t pinCSN)
+   
+  \brief set up SPI device profile
+
+  \param[out] pProfile  profile to set up
+  \param[in]  type      4-wire full-duplex(=SPI_4_WIRE) or 3-wire half duplex(=SPI_3_WIRE)
+  \param[in]  pre       baudrate prescaler (BR=F_CPU/2^(pre+1))
+  \param[in]  order     bit order: MSBFIRST or LSBFIRST
+  \param[in]  mode      SPI clock polarity & phase (SPI_MODE0..3)
+  \param[in]  pPortCSN  pointer to port of CSN, e.g. &PORT_A. NULL for no CSN control
+  \param[in]  pinCSN    CSN pin number (0..7)
+
+  calculate SPI register values for a slave device, like spi_init_master(),
+  and configure CSN pin as output high. SPI is not changed, see spi_select().
+  Note: call spi_init_master() once before for SPI pin setup
+*/
+void spi_initProfile(spi_profile_t *pProfile, uint8_t type, uint8_t pre, uint8_t order, uint8_t mode, PORT_t *pPortCSN, uint8_t pinCSN) {
+
+  // CR1: bit order, enable, prescaler, master, CPOL (=mode bit 1), CPHA (=mode bit 0)
+  pProfile->CR1 = (uint8_t) (((order & 0x01) << 7) | 0x40 | ((pre & 0x07) << 3) | 0x04 | (mode & 0x03));
+
+  // CR2: 3-wire (BDM), SW slave management (SSM, SSI)
+  pProfile->CR2 = (uint8_t) ((type == SPI_3_WIRE) ? 0x83 : 0x03);
+
+  // configure CSN pin (high = not selected)
+  pProfile->pPortCSN = pPortCSN;
+  pProfile->pinCSN   = pinCSN;
+  if (pPortCSN != NULL) {
+    pinHigh(pPortCSN, pinCSN);
+    pinMode(pPortCSN, pinCSN, OUTPUT);
+  }
+
+} // spi_initProfile
+
+
+
+/**
+  \fn void spi_select(spi_profile_t *pProfile)
+   
+  \brief switch SPI to device profile and select slave
+
+  \param[in]  pProfile  device profile, see spi_initProfile()
+
+  wait until SPI is idle, de-select previous slave, apply SPI settings
+  of profile and select slave via CSN=low. Registers are only written if
+  settings differ, i.e. selecting the same device again is fast
+*/
+void spi_select(spi_profile_t *pProfile) {
+
+  // wait until queued transfers and current frame are finished
+  #if defined(USE_SPI_QUEUE)
+    while (g_spi_pQueue != NULL);
+  #endif
+  while (SPI.SR.reg.BSY);
+
+  // de-select previous slave
+  spi_deselect();
+
+  // apply settings only if changed. BR, CPOL, CPHA must not change while enabled
+  if ((SPI.CR1.byte != pProfile->CR1) || (SPI.CR2.byte != pProfile->CR2)) {
+    SPI.CR1.reg.SPE = 0;
+    SPI.CR2.byte = pProfile->CR2;
+    SPI.CR1.byte = pProfile->CR1 & ~0x40;
+    SPI.CR1.byte = pProfile->CR1;
+  }
+
+  // select slave
+  if (pProfile->pPortCSN != NULL)
+    pinLow(pProfile->pPortCSN, pProfile->pinCSN);
+  m_spi_pSelected = pProfile;
+
+} // spi_select
+
+
+
+/**
+  \fn void spi_deselect(void)
+   
+  \brief de-select current slave
+
+  wait until current frame is finished, then set CSN of slave
+  selected by spi_select() high
+*/
+void spi_deselect() {
+
+  spi_profile_t   *pProfile = m_spi_pSelected;
+
+  // nothing selected
+  if (pProfile == NULL)
+    return;
+
+  // wait until frame finished, then de-select
+  while (SPI.SR.reg.BSY);
+  if (pProfile->pPortCSN != NULL)
+    pinHigh(pProfile->pPortCSN, pProfile->pinCSN);
+  m_spi_pSelected = NULL;
+
+} // spi_deselect
+
+
+
+/**
+  \fn void spi_write(uint16_t num, uint8_t *buf)
+   
+  \brief send data via SPI (master mode)
+
+  \param[in]  num     number of bytes to send
+  \param[in]  buf     send buffer
+
+  send data in 4-wire mode w/o CSN control, e.g. for display or DAC. Next byte
+  is written as soon as TX buffer is empty, i.e. SCK runs continuously.
+  Received data is discarded
+*/
+void spi_write(uint16_t num, uint8_t *buf) {
+
+  uint8_t   dummy;
+
+  // keep TX buffer filled
+  while (num--) {
+    while (!(SPI.SR.byte & 0x02));              // wait for TXE
+    SPI.DR.byte = *(buf++);
+  }
+
+  // wait until last frame finished, then clear RXNE and OVR (read DR, then SR)
+  while (SPI.SR.reg.BSY);
+  dummy = SPI.DR.byte;
+  dummy = SPI.SR.byte;
+  (void) dummy;
+
+} // spi_write
+
+
+
+/**
+  \fn uint8_t spi_transfer(uint16_t num, uint8_t *bufTx, uint8_t *bufRx)
+   
+  \brief exchange data via SPI (master mode)
+
+  \param[in]  num     number of bytes to exchange
+  \param[in]  bufTx   send buffer. NULL to send 0xFF (see spi_read())
+  \param[out] bufRx   receive buffer
+
+  \return error code (0=ok; 1=receive overrun, transfer aborted)
+
+  full-duplex transfer in 4-wire mode w/o CSN control. The next byte is written
+  to the TX buffer while the current byte is shifted, then the previous byte
+  is read. This keeps SCK running continuously also at f_CPU/2.
+  Note: an interrupt longer than ~1 frame between writing the next and reading
+  the previous byte causes an overrun, i.e. a received byte is lost. Because
+  reading DR, then SR clears OVR, the flag is latched from every SR read. On
+  overrun the transfer is aborted w/o waiting for the lost byte and bufRx is
+  incomplete. For interrupt-safe transfers disable interrupts or use
+  spi_send_receive()
+*/
+uint8_t spi_transfer(uint16_t num, uint8_t *bufTx, uint8_t *bufRx) {
+
+  uint8_t   sr, flags;
+
+  // nothing to do
+  if (num == 0)
+    return(0);
+
+  // clear RXNE and OVR (read DR, then SR)
+  sr = SPI.DR.byte;
+  sr = SPI.SR.byte;
+  flags = 0x00;
+
+  // start 1st byte
+  SPI.DR.byte = (bufTx != NULL) ? *(bufTx++) : 0xFF;
+
+  // pre-load next byte, then read current byte. Latch OVR from all SR reads
+  if (bufTx != NULL) {
+    while (--num) {
+      do { sr = SPI.SR.byte; flags |= sr; } while (!(sr & 0x02));         // wait for TXE
+      if (flags & 0x40) break;
+      SPI.DR.byte = *(bufTx++);
+      do { sr = SPI.SR.byte; flags |= sr; } while (!(sr & 0x41));         // wait for RXNE or OVR
+      *(bufRx++) = SPI.DR.byte;
+    }
+  }
+  else {
+    while (--num) {
+      do { sr = SPI.SR.byte; flags |= sr; } while (!(sr & 0x02));         // wait for TXE
+      if (flags & 0x40) break;
+      SPI.DR.byte = 0xFF;
+      do { sr = SPI.SR.byte; flags |= sr; } while (!(sr & 0x41));         // wait for RXNE or OVR
+      *(bufRx++) = SPI.DR.byte;
+    }
+  }
+
+  // read last byte. On overrun it may never arrive
+  if (!(flags & 0x40)) {
+    do { sr = SPI.SR.byte; flags |= sr; } while (!(sr & 0x41));           // wait for RXNE or OVR
+    *bufRx = SPI.DR.byte;
+    flags |= SPI.SR.byte;
+  }
+
+  // on overrun wait until bus idle, then clear RXNE and OVR (read DR, then SR)
+  if (flags & 0x40) {
+    while (SPI.SR.reg.BSY);
+    sr = SPI.DR.byte;
+    sr = SPI.SR.byte;
+    return(1);
+  }
+
+  return(0);
+
+} // spi_transfer
+
+
 
 /**
   \fn void spi_send_receive(PORT_t *pPortCSN, uint8_t pinCSN, uint8_t numMOSI, uint8_t *MOSI, uint8_t numMISO, uint8_t *MISO)
@@ -175,16 +399,18 @@ void spi_restore_config(uint8_t N) {
   \param[in]  pPortCSN   pointer to port of CSN, e.g. &PORT_A
   \param[in]  pinCSN     CSN pin number (0..7)
   \param[in]  numMOSI    number of bytes to send per frame
-  \param[in]  MOSI       array of MOSI bytes [0..MAX_WIDTH_SPI-1]
+  \param[in]  MOSI       array of MOSI bytes [0..numMOSI-1]
   \param[in]  numMISO    number of bytes to receive per frame (=ignored for full-duplex)
-  \param[out] MISO       array of MISO bytes [0..MAX_WIDTH_SPI-1]
+  \param[out] MISO       array of MISO bytes [0..numMOSI-1] (full-duplex) or [0..numMISO-1] (half-duplex)
 
-  send/receive via SPI in master mode i.e. CSN control is by muBoard
-  
+  send/receive via SPI in master mode incl. CSN control. Bit order is handled by SPI
+  hardware, i.e. buffers are always in transmission order. Bytes are exchanged one
+  by one, i.e. interrupts can't cause an overrun. For fast transfers without
+  CSN control or with >255 bytes see spi_write(), spi_read() and spi_transfer()
 */
 void spi_send_receive(PORT_t *pPortCSN, uint8_t pinCSN, uint8_t numMOSI, uint8_t *MOSI, uint8_t numMISO, uint8_t *MISO) {
   
-  uint8_t		i;
+  uint8_t   i;
     
   // wait until not busy
   while (SPI.SR.reg.BSY);
@@ -192,54 +418,29 @@ void spi_send_receive(PORT_t *pPortCSN, uint8_t pinCSN, uint8_t numMOSI, uint8_t
   // select SPI slave via CSN=low
   pinLow(pPortCSN, pinCSN);
 
-  // full-duplex mode (= 4-wire)
+  // full-duplex mode (= 4-wire). Send byte, then wait until received
   if (SPI.CR2.reg.BDM == SPI_4_WIRE) {
-  
-    // loop over MOSI
     for (i=0; i<numMOSI; i++) {
-        
-      // fill MOSI buffer when SPI free
       while (!SPI.SR.reg.TXE);
-      if (SPI.CR1.reg.xLSBFIRST == MSBFIRST)
-        SPI.DR.byte = MOSI[i];
-      else
-        SPI.DR.byte = MOSI[numMOSI-i];
-        
-      // copy MISO byte after received
-      while (SPI.SR.reg.RXNE != 0);
-      if (SPI.CR1.reg.xLSBFIRST == MSBFIRST)
-        MISO[i] = SPI.DR.byte;
-      else
-        MISO[numMOSI-i] = SPI.DR.byte;
-      
-    } // loop over MOSI
-
-  } // full-duplex mode
-  
+      SPI.DR.byte = MOSI[i];
+      while (!SPI.SR.reg.RXNE);
+      MISO[i] = SPI.DR.byte;
+    }
+  }
   
   // half duplex mode (= 3-wire)
   else {
   
-    // switch SPI data pin to output
-    while (SPI.SR.reg.BSY);
+    // switch SPI data pin to output and send MOSI bytes
     SPI.CR2.reg.BDOE = 1;   
-
-    // send MOSI bytes
     for (i=0; i<numMOSI; i++) {
-        
-      // fill MOSI buffer when available
       while (!SPI.SR.reg.TXE);
-      if (SPI.CR1.reg.xLSBFIRST == MSBFIRST)
-        SPI.DR.byte = MOSI[i];
-      else
-        SPI.DR.byte = MOSI[numMOSI-i];
-        
-    } // loop over MOSI
-    
+      SPI.DR.byte = MOSI[i];
+    }
     
     // switch SPI data pin to input
     while (SPI.SR.reg.BSY);
-		SPI.CR2.reg.BDOE = 0;   
+    SPI.CR2.reg.BDOE = 0;   
 
     // receive MISO bytes
     for (i=0; i<numMISO; i++) {
@@ -249,11 +450,8 @@ void spi_send_receive(PORT_t *pPortCSN, uint8_t pinCSN, uint8_t numMOSI, uint8_t
       SPI.DR.byte = 0xFF;
         
       // copy MISO byte after received
-      while (SPI.SR.reg.RXNE != 0);
-      if (SPI.CR1.reg.xLSBFIRST == MSBFIRST)
-        MISO[i] = SPI.DR.byte;
-      else
-        MISO[numMISO-i] = SPI.DR.byte;
+      while (!SPI.SR.reg.RXNE);
+      MISO[i] = SPI.DR.byte;
       
     } // loop over MISO
       
@@ -268,6 +466,180 @@ void spi_send_receive(PORT_t *pPortCSN, uint8_t pinCSN, uint8_t numMOSI, uint8_t
 } // spi_send_receive
 
 
+#if defined(USE_SPI_QUEUE)
+
+  /**
+    \fn void spi_startNext(void)
+   
+    \brief start next queued transfer
+
+    select slave of transfer at head of queue and send first byte.
+    Further bytes are sent from RXNE ISR, i.e. one byte at a time, which
+    avoids receive overrun independent of interrupt latency.
+    If queue is empty, disable SPI interrupts
+  */
+  static void spi_startNext(void) {
+
+    spi_trans_t   *pTrans = g_spi_pQueue;
+    uint8_t       dummy;
+
+    // queue empty -> disable interrupts
+    if (pTrans == NULL) {
+      SPI.ICR.byte = m_spi_icr = 0x00;
+      return;
+    }
+
+    // select slave
+    m_spi_idx = 0;
+    if (pTrans->pPortCSN != NULL)
+      pinLow(pTrans->pPortCSN, pTrans->pinCSN);
+
+    // clear pending RXNE and OVR (read DR, then SR)
+    dummy = SPI.DR.byte;
+    dummy = SPI.SR.byte;
+    (void) dummy;
+
+    // send 1st byte, remaining bytes via RXNE (+ error) interrupt
+    SPI.DR.byte = (pTrans->bufTx != NULL) ? pTrans->bufTx[0] : 0xFF;
+    SPI.ICR.byte = m_spi_icr = 0x60;
+
+  } // spi_startNext
+
+
+
+  /**
+    \fn void spi_finish(uint8_t status)
+   
+    \brief finish active transfer
+
+    \param[in]  status    result, SPI_OK or SPI_ERR_xxx
+
+    de-select slave (unless SPI_KEEP_CS), remove transfer from queue, start
+    next transfer and call completion callback of finished transfer.
+    Callback is called last, so it may submit a new transfer
+  */
+  static void spi_finish(uint8_t status) {
+
+    spi_trans_t   *pTrans = g_spi_pQueue;
+
+    // wait until last frame finished, then de-select slave
+    while (SPI.SR.reg.BSY);
+    if ((pTrans->pPortCSN != NULL) && (!(pTrans->flags & SPI_KEEP_CS)))
+      pinHigh(pTrans->pPortCSN, pTrans->pinCSN);
+
+    // remove from queue and start next
+    g_spi_pQueue = pTrans->pNext;
+    pTrans->status = status;
+    spi_startNext();
+
+    // notify user
+    if (pTrans->pCallback != NULL)
+      pTrans->pCallback(pTrans);
+
+  } // spi_finish
+
+
+
+  /**
+    \fn uint8_t spi_submit(spi_trans_t *pTrans)
+   
+    \brief add transfer to queue
+
+    \param[in]  pTrans    transfer. Must stay valid until status != SPI_PENDING
+
+    \return error code (0=ok; 1=transfer is empty or already queued)
+
+    add transfer to end of queue and start it if SPI is idle. The transfer is
+    processed in the background by the SPI ISR, i.e. this function returns
+    immediately. Check pTrans->status or use pTrans->pCallback for completion.
+    May also be called from a completion callback.
+    Note: requires 4-wire mode. SPI settings must not be changed and
+    spi_send_receive() must not be used while the queue is not empty
+  */
+  uint8_t spi_submit(spi_trans_t *pTrans) {
+
+    spi_trans_t   *p;
+
+    // nothing to transfer
+    if (pTrans->num == 0)
+      return(1);
+
+    // lock out SPI ISR
+    SPI.ICR.byte = 0x00;
+
+    // don't link transfer twice
+    for (p=g_spi_pQueue; p!=NULL; p=p->pNext) {
+      if (p == pTrans) {
+        SPI.ICR.byte = m_spi_icr;
+        return(1);
+      }
+    }
+
+    // append to queue
+    pTrans->status = SPI_PENDING;
+    pTrans->pNext  = NULL;
+    if (g_spi_pQueue == NULL) {
+      g_spi_pQueue = pTrans;
+      m_spi_pTail  = pTrans;
+      spi_startNext();
+    }
+    else {
+      m_spi_pTail->pNext = pTrans;
+      m_spi_pTail        = pTrans;
+      SPI.ICR.byte = m_spi_icr;
+    }
+
+    // return success
+    return(0);
+
+  } // spi_submit
+
+
+
+  /**
+    \fn void SPI_ISR(void)
+   
+    \brief SPI interrupt service routine
+
+    store received byte and send next byte of active transfer.
+    On overrun the transfer is aborted and the next one is started
+  */
+  ISR_HANDLER(SPI_ISR, __SPI_VECTOR__) {
+
+    spi_trans_t   *pTrans = g_spi_pQueue;
+    uint8_t       data;
+
+    // no active transfer -> disable interrupts
+    if (pTrans == NULL) {
+      SPI.ICR.byte = m_spi_icr = 0x00;
+      return;
+    }
+
+    // receive overrun -> clear flag (read DR, then SR) and abort
+    if (SPI.SR.reg.OVR) {
+      data = SPI.DR.byte;
+      data = SPI.SR.byte;
+      spi_finish(SPI_ERR_OVR);
+      return;
+    }
+
+    // store received byte
+    data = SPI.DR.byte;
+    if (pTrans->bufRx != NULL)
+      pTrans->bufRx[m_spi_idx] = data;
+
+    // send next byte or finish
+    if (++m_spi_idx < pTrans->num)
+      SPI.DR.byte = (pTrans->bufTx != NULL) ? pTrans->bufTx[m_spi_idx] : 0xFF;
+    else
+      spi_finish(SPI_OK);
+
+  } // SPI_ISR
+
+#endif // USE_SPI_QUEUE
+
+
+
 /*-----------------------------------------------------------------------------
     END OF MODULE
 -----------------------------------------------------------------------------*/
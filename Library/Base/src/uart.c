@@ -0,0 +1,656 @@
+/**
+  \file uart.c
+
+  \author G. Icking-Konert
+  \date 2026-10-17
+  \version 0.1
+
+  \brief implementation of generic UART functions & macros
+
+  implementation of generic UART functions used by all UART instances (UART1..4).
+  Each instance is described by a descriptor (see uart1.c..uart4.c), which
+  selects the registers and optional ring buffers. Polling and buffered mode are
+  implemented here once.
+*/
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "stm8as.h"
+#include "config.h"
+#include "uart.h"
+
+
+/*----------------------------------------------------------
+    FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn int16_t UART_begin(UART_desc_t *pDesc, uint32_t BR)
+
+  \brief initialize UART for communication
+
+  \param[in]  pDesc   UART descriptor, e.g. &g_UART1
+  \param[in]  BR      baudrate [Baud]
+
+  \return  baudrate error [0.01%]. +/-INT16_MAX if BR is out of range
+
+  initialize UART for communication with specified baudrate. Baudrate
+  divider is calculated from actual master clock (see clock.h).
+  Use 1 start, 8 data and 1 stop bit; no parity or flow control.
+*/
+int16_t UART_begin(UART_desc_t *pDesc, uint32_t BR) {
+
+  uint32_t  fMaster, div;
+  int16_t   err;
+
+  // get baudrate divider, rounded to nearest
+  fMaster = CLK_getMaster();
+  div = (fMaster + (BR >> 1)) / BR;
+
+  // clip to valid range and calculate achieved baudrate error
+  if (div < UART_DIV_MIN) {
+    div = UART_DIV_MIN;
+    err = -INT16_MAX;
+  }
+  else if (div > UART_DIV_MAX) {
+    div = UART_DIV_MAX;
+    err = INT16_MAX;
+  }
+  else
+    err = (int16_t) ((int32_t) (fMaster - div*BR) / (int32_t) ((div*BR + 5000L) / 10000L));  // avoid 32-bit overflow
+
+  // set UART registers
+  UART_beginDiv(pDesc, (uint16_t) div);
+
+  return(err);
+
+} // UART_begin
+
+
+
+/**
+  \fn void UART_beginDiv(UART_desc_t *pDesc, uint16_t div)
+
+  \brief initialize UART for communication with given baudrate divider
+
+  \param[in]  pDesc   UART descriptor, e.g. &g_UART1
+  \param[in]  div     baudrate divider f_MASTER/BR, see UART_DIV()
+
+  initialize UART for communication with precalculated baudrate divider.
+  Use 1 start, 8 data and 1 stop bit; no parity or flow control.
+  In buffered mode also reset buffers and enable receive interrupt.
+*/
+void UART_beginDiv(UART_desc_t *pDesc, uint16_t div) {
+
+  volatile UART_t   *pReg = pDesc->pReg;
+
+  // set UART behaviour
+  pReg->CR1.byte = UART1_CR1_RESET_VALUE;  // enable UART, 8 data bits, no parity control
+  pReg->CR2.byte = UART1_CR2_RESET_VALUE;  // no interrupts, disable sender/receiver
+  pReg->CR3.byte = UART1_CR3_RESET_VALUE;  // no LIN support, 1 stop bit, no clock output(?)
+
+  // set baudrate (note: BRR2 must be written before BRR1!)
+  pReg->BRR2.byte = (uint8_t) (((div & 0xF000) >> 8) | (div & 0x000F));
+  pReg->BRR1.byte = (uint8_t) ((div & 0x0FF0) >> 4);
+
+  // for buffered mode reset buffers and enable receive interrupt. Send interrupt is enabled on demand
+  #if defined(UART_USE_BUFFER)
+    pDesc->tx.head = pDesc->tx.tail = 0;
+    pDesc->rx.head = pDesc->rx.tail = 0;
+    pDesc->tx.overflow = 0;
+    pDesc->rx.overflow = 0;
+    pDesc->pAsync = NULL;
+    pDesc->numAsync = 0;
+    pDesc->idleHead = 0;
+    if (pDesc->rx.buf != NULL)
+      pReg->CR2.reg.RIEN = 1;
+  #endif
+
+  // enable transmission
+  pReg->CR2.reg.REN = 1; // enable receiver
+  pReg->CR2.reg.TEN = 1; // enable sender
+
+} // UART_beginDiv
+
+
+
+/**
+  \fn void UART_end(UART_desc_t *pDesc)
+
+  \brief UART disable sender & receiver
+
+  \param[in]  pDesc   UART descriptor, e.g. &g_UART1
+
+  UART disable sender & receiver and interrupts. Retain previous settings
+*/
+void UART_end(UART_desc_t *pDesc) {
+
+  volatile UART_t   *pReg = pDesc->pReg;
+
+  // disable sender & receiver
+  pReg->CR2.reg.TEN  = 0;
+  pReg->CR2.reg.REN  = 0;
+
+  // disable interrupts used in buffered mode
+  pReg->CR2.reg.TIEN  = 0;
+  pReg->CR2.reg.TCIEN = 0;
+  pReg->CR2.reg.RIEN  = 0;
+  pReg->CR2.reg.ILIEN = 0;
+
+  // abort zero-copy transfer
+  #if defined(UART_USE_BUFFER)
+    pDesc->numAsync = 0;
+    pDesc->pAsync   = NULL;
+  #endif
+
+} // UART_end
+
+
+
+/**
+  \fn uint8_t UART_available(UART_desc_t *pDesc)
+
+  \brief check if received data is available
+
+  \param[in]  pDesc   UART descriptor, e.g. &g_UART1
+
+  \return  number of bytes waiting (polling mode: 0 or 1)
+
+  return number of received bytes not yet read
+*/
+uint8_t UART_available(UART_desc_t *pDesc) {
+
+  // buffered mode: bytes in receive buffer
+  #if defined(UART_USE_BUFFER)
+    if (pDesc->rx.buf != NULL)
+      return((uint8_t) (pDesc->rx.head - pDesc->rx.tail));
+  #endif
+
+  // polling mode: data in Rx register
+  return(pDesc->pReg->SR.reg.RXNE);
+
+} // UART_available
+
+
+
+/**
+  \fn void UART_write(UART_desc_t *pDesc, uint8_t data)
+
+  \brief send byte via UART
+
+  \param[in]  pDesc   UART descriptor, e.g. &g_UART1
+  \param[in]  data    byte to send
+
+  send byte via UART as soon as possible. In buffered mode copy byte
+  to send buffer and only block while buffer is full
+*/
+void UART_write(UART_desc_t *pDesc, uint8_t data) {
+
+  // buffered mode
+  #if defined(UART_USE_BUFFER)
+    if (pDesc->tx.buf != NULL) {
+
+      // wait until buffer has space. Is emptied by TXE ISR
+      while ((uint8_t) (pDesc->tx.head - pDesc->tx.tail) > pDesc->tx.mask);
+
+      // copy to buffer
+      pDesc->tx.buf[pDesc->tx.head & pDesc->tx.mask] = data;
+      pDesc->tx.head++;
+
+      // (re-)start sending via TXE ISR
+      pDesc->pReg->CR2.reg.TIEN = 1;
+
+      return;
+
+    }
+  #endif // UART_USE_BUFFER
+
+  // polling mode: wait until TX register is available, then send
+  while (!(pDesc->pReg->SR.reg.TXE));
+  pDesc->pReg->DR.byte = data;
+
+} // UART_write
+
+
+
+/**
+  \fn void UART_writeBytes(UART_desc_t *pDesc, uint16_t num, uint8_t *buf)
+
+  \brief send array of bytes via UART
+
+  \param[in]  pDesc   UART descriptor, e.g. &g_UART1
+  \param[in]  num     buf size in bytes
+  \param[in]  buf     bytes to send
+
+  send array of bytes via UART. In buffered mode only
+  block while send buffer is full
+*/
+void UART_writeBytes(UART_desc_t *pDesc, uint16_t num, uint8_t *buf) {
+
+  uint16_t i;
+
+  // send bytes
+  for (i=0; i<num; i++) {
+    UART_write(pDesc, buf[i]);
+  }
+
+} // UART_writeBytes
+
+
+
+/**
+  \fn uint8_t UART_read(UART_desc_t *pDesc)
+
+  \brief UART byte receive function. Blocking
+
+  \param[in]  pDesc   UART descriptor, e.g. &g_UART1
+
+  \return received byte
+
+  wait until byte received via UART and return it
+*/
+uint8_t UART_read(UART_desc_t *pDesc) {
+
+  // buffered mode
+  #if defined(UART_USE_BUFFER)
+    if (pDesc->rx.buf != NULL) {
+
+      uint8_t   data;
+
+      // wait until byte received. Buffer is filled by RXF ISR
+      while (pDesc->rx.head == pDesc->rx.tail);
+
+      // get oldest byte
+      data = pDesc->rx.buf[pDesc->rx.tail & pDesc->rx.mask];
+      pDesc->rx.tail++;
+
+      return(data);
+
+    }
+  #endif // UART_USE_BUFFER
+
+  // polling mode: wait until byte received, then return Rx register
+  while (!(pDesc->pReg->SR.reg.RXNE));
+  return(pDesc->pReg->DR.byte);
+
+} // UART_read
+
+
+
+#if defined(UART_USE_BUFFER)
+
+  /**
+    \fn uint8_t UART_availableForWrite(UART_desc_t *pDesc)
+
+    \brief number of free bytes in send buffer
+
+    \param[in]  pDesc   UART descriptor, e.g. &g_UART1
+
+    \return  number of bytes which can be queued without blocking
+
+    return number of free bytes in UART send buffer
+  */
+  uint8_t UART_availableForWrite(UART_desc_t *pDesc) {
+
+    return((uint8_t) (pDesc->tx.mask + 1 - (uint8_t) (pDesc->tx.head - pDesc->tx.tail)));
+
+  } // UART_availableForWrite
+
+
+
+  /**
+    \fn uint8_t UART_tryWrite(UART_desc_t *pDesc, uint8_t data)
+
+    \brief queue byte for sending if send buffer has space
+
+    \param[in]  pDesc   UART descriptor, e.g. &g_UART1
+    \param[in]  data    byte to send
+
+    \return  1=byte queued, 0=send buffer full
+
+    copy byte to send buffer if possible and return immediately.
+    Unlike UART_writeNonBlocking() a full buffer is not counted in
+    tx.overflow, i.e. caller decides how to handle it
+  */
+  uint8_t UART_tryWrite(UART_desc_t *pDesc, uint8_t data) {
+
+    uint8_t   head = pDesc->tx.head;
+
+    // buffer full
+    if ((uint8_t) (head - pDesc->tx.tail) > pDesc->tx.mask)
+      return(0);
+
+    // copy to buffer
+    pDesc->tx.buf[head & pDesc->tx.mask] = data;
+    pDesc->tx.head = head + 1;
+
+    // (re-)start sending via TXE ISR
+    pDesc->pReg->CR2.reg.TIEN = 1;
+
+    return(1);
+
+  } // UART_tryWrite
+
+
+
+  /**
+    \fn uint16_t UART_writeNonBlocking(UART_desc_t *pDesc, uint16_t num, uint8_t *buf)
+
+    \brief queue bytes for sending without blocking
+
+    \param[in]  pDesc   UART descriptor, e.g. &g_UART1
+    \param[in]  num     number of bytes to send
+    \param[in]  buf     bytes to send
+
+    \return  number of bytes queued (<num if send buffer is full)
+
+    copy as many bytes as fit into send buffer and return immediately.
+    Bytes not fitting are counted in tx.overflow
+  */
+  uint16_t UART_writeNonBlocking(UART_desc_t *pDesc, uint16_t num, uint8_t *buf) {
+
+    uint8_t   head, space, mask;
+    uint16_t  i;
+
+    // get free space once. ISR can only increase it meanwhile
+    mask  = pDesc->tx.mask;
+    head  = pDesc->tx.head;
+    space = (uint8_t) (mask + 1 - (uint8_t) (head - pDesc->tx.tail));
+    if (num > space) {
+      pDesc->tx.overflow += (uint16_t) (num - space);
+      num = space;
+    }
+
+    // copy to buffer and publish new head once
+    for (i=0; i<num; i++)
+      pDesc->tx.buf[(head++) & mask] = buf[i];
+    pDesc->tx.head = head;
+
+    // (re-)start sending via TXE ISR
+    if (num)
+      pDesc->pReg->CR2.reg.TIEN = 1;
+
+    return(num);
+
+  } // UART_writeNonBlocking
+
+
+
+  /**
+    \fn void UART_flush(UART_desc_t *pDesc)
+
+    \brief wait until all queued bytes are sent
+
+    \param[in]  pDesc   UART descriptor, e.g. &g_UART1
+
+    wait until UART send buffer is empty and last byte has left the shift register
+  */
+  void UART_flush(UART_desc_t *pDesc) {
+
+    // wait until buffers are empty and transmission is complete
+    while ((pDesc->tx.head != pDesc->tx.tail) || (pDesc->numAsync));
+    while (!(pDesc->pReg->SR.reg.TC));
+
+  } // UART_flush
+
+
+
+  /**
+    \fn uint8_t UART_writeAsync(UART_desc_t *pDesc, uint16_t num, uint8_t *buf, void (*pFct)(void))
+
+    \brief send buffer in background without copy
+
+    \param[in]  pDesc   UART descriptor, e.g. &g_UART1
+    \param[in]  num     number of bytes to send
+    \param[in]  buf     bytes to send. Must not be changed until pFct is called
+    \param[in]  pFct    function to call from ISR after last byte is sent (TC flag). NULL for none
+
+    \return  1=transfer started, 0=busy with previous transfer or send buffer not empty
+
+    start sending buffer via TXE ISR directly from caller memory, i.e. without copy
+    to the send buffer. Bytes written via UART_write() meanwhile are sent after buf.
+    Use UARTn_isBusyAsync() or the callback to check for completion.
+  */
+  uint8_t UART_writeAsync(UART_desc_t *pDesc, uint16_t num, uint8_t *buf, void (*pFct)(void)) {
+
+    // previous transfer or send buffer still active -> reject to maintain byte order
+    if ((pDesc->pAsync != NULL) || (pDesc->tx.head != pDesc->tx.tail))
+      return(0);
+
+    // nothing to send -> done
+    if (num == 0) {
+      if (pFct != NULL)
+        pFct();
+      return(1);
+    }
+
+    // store transfer. Is not accessed by ISR, because TXE and TC interrupts are disabled here
+    pDesc->pAsyncDone = pFct;
+    pDesc->numAsync   = num;
+    pDesc->pAsync     = buf;
+
+    // start sending via TXE ISR
+    pDesc->pReg->CR2.reg.TIEN = 1;
+
+    return(1);
+
+  } // UART_writeAsync
+
+
+
+  /**
+    \fn void UART_attachReceive(UART_desc_t *pDesc, void (*pFct)(uint8_t))
+
+    \brief set function to call for each received byte
+
+    \param[in]  pDesc   UART descriptor, e.g. &g_UART1
+    \param[in]  pFct    function called from RXF ISR with received byte. NULL to use receive buffer
+
+    set function which is called from RXF ISR for each received byte, e.g. a protocol
+    state machine. While attached, received bytes are not stored in the receive buffer
+  */
+  void UART_attachReceive(UART_desc_t *pDesc, void (*pFct)(uint8_t)) {
+
+    // avoid call of partially updated pointer by ISR
+    pDesc->pReg->CR2.reg.RIEN = 0;
+    pDesc->pRxFct = pFct;
+    pDesc->pReg->CR2.reg.RIEN = 1;
+
+  } // UART_attachReceive
+
+
+
+  /**
+    \fn void UART_enableIdle(UART_desc_t *pDesc, void (*pFct)(void))
+
+    \brief enable burst receive via idle line detection
+
+    \param[in]  pDesc   UART descriptor, e.g. &g_UART1
+    \param[in]  pFct    function called from RXF ISR at end of burst. NULL for none
+
+    enable IDLE interrupt, which is triggered once after a burst of received bytes,
+    i.e. if the line is idle for one frame time. Then the burst is complete in the
+    receive buffer, see UART_availableBurst() and UART_readBurst()
+  */
+  void UART_enableIdle(UART_desc_t *pDesc, void (*pFct)(void)) {
+
+    // avoid call of partially updated pointer by ISR
+    pDesc->pReg->CR2.reg.ILIEN = 0;
+    pDesc->pIdleFct = pFct;
+    pDesc->idleHead = pDesc->rx.tail;
+    pDesc->pReg->CR2.reg.ILIEN = 1;
+
+  } // UART_enableIdle
+
+
+
+  /**
+    \fn uint8_t UART_availableBurst(UART_desc_t *pDesc)
+
+    \brief number of bytes of completed bursts
+
+    \param[in]  pDesc   UART descriptor, e.g. &g_UART1
+
+    \return  number of buffered bytes received before last idle line
+
+    return number of bytes in receive buffer which belong to completed
+    bursts, i.e. were followed by an idle line. Requires UART_enableIdle()
+  */
+  uint8_t UART_availableBurst(UART_desc_t *pDesc) {
+
+    uint8_t   tail = pDesc->rx.tail;
+    uint8_t   num  = (uint8_t) (pDesc->idleHead - tail);
+
+    // tail already passed idle mark, e.g. via UART_read()
+    if (num > (uint8_t) (pDesc->rx.head - tail))
+      return(0);
+
+    return(num);
+
+  } // UART_availableBurst
+
+
+
+  /**
+    \fn uint8_t UART_readBurst(UART_desc_t *pDesc, uint8_t *buf, uint8_t max)
+
+    \brief read completed burst from receive buffer
+
+    \param[in]  pDesc   UART descriptor, e.g. &g_UART1
+    \param[out] buf     buffer for received bytes
+    \param[in]  max     size of buf [B]
+
+    \return  number of bytes copied to buf (0 if no burst is completed)
+
+    copy bytes of completed bursts from receive buffer to buf. Never blocks.
+    Requires UART_enableIdle()
+  */
+  uint8_t UART_readBurst(UART_desc_t *pDesc, uint8_t *buf, uint8_t max) {
+
+    uint8_t   num, tail, i;
+
+    // get size of completed bursts
+    num = UART_availableBurst(pDesc);
+    if (num > max)
+      num = max;
+
+    // copy from buffer and publish new tail once
+    tail = pDesc->rx.tail;
+    for (i=0; i<num; i++)
+      buf[i] = pDesc->rx.buf[(tail++) & pDesc->rx.mask];
+    pDesc->rx.tail = tail;
+
+    return(num);
+
+  } // UART_readBurst
+
+
+
+  /**
+    \fn void UART_TXE_handler(UART_desc_t *pDesc)
+
+    \brief handler for UART send interrupt
+
+    \param[in]  pDesc   UART descriptor, e.g. &g_UART1
+
+    send next byte from zero-copy buffer or send buffer. If both are empty
+    disable interrupt, else it would stall the device. After last byte of
+    zero-copy buffer wait for TC flag, then call completion callback
+  */
+  void UART_TXE_handler(UART_desc_t *pDesc) {
+
+    volatile UART_t   *pReg = pDesc->pReg;
+    uint8_t           tail = pDesc->tx.tail;
+
+    // TX register empty -> send next byte. Writing DR clears TXE and TC
+    if (pReg->SR.reg.TXE) {
+
+      // zero-copy buffer has priority, see UART_writeAsync()
+      if (pDesc->numAsync) {
+        pReg->DR.byte = *(pDesc->pAsync++);
+        if (--(pDesc->numAsync) == 0)
+          pReg->CR2.reg.TCIEN = 1;
+      }
+
+      // next byte from send buffer
+      else if (tail != pDesc->tx.head) {
+        pReg->DR.byte = pDesc->tx.buf[tail & pDesc->tx.mask];
+        pDesc->tx.tail = ++tail;
+      }
+
+      // if buffers are empty disable send interrupt (important!)
+      if ((pDesc->numAsync == 0) && (tail == pDesc->tx.head))
+        pReg->CR2.reg.TIEN = 0;
+
+    } // TXE
+
+    // zero-copy transfer complete, i.e. last byte has left shift register
+    if ((pReg->CR2.reg.TCIEN) && (pReg->SR.reg.TC)) {
+      pReg->CR2.reg.TCIEN = 0;
+      pDesc->pAsync = NULL;
+      if (pDesc->pAsyncDone != NULL)
+        pDesc->pAsyncDone();
+    }
+
+  } // UART_TXE_handler
+
+
+
+  /**
+    \fn void UART_RXF_handler(UART_desc_t *pDesc)
+
+    \brief handler for UART receive interrupt
+
+    \param[in]  pDesc   UART descriptor, e.g. &g_UART1
+
+    copy received byte to receive buffer or pass it to attached function.
+    If buffer is full or hardware overrun occurred, increase overflow counter.
+    On idle line mark end of burst and call attached idle function
+  */
+  void UART_RXF_handler(UART_desc_t *pDesc) {
+
+    uint8_t   status, data, head;
+
+    // read SR, then DR. Clears RXNE, IDLE and overrun flag
+    status = pDesc->pReg->SR.byte;
+    data   = pDesc->pReg->DR.byte;
+
+    // byte lost in hardware (overrun flag = bit 3)
+    if (status & 0x08)
+      pDesc->rx.overflow++;
+
+    // byte received (RXNE = bit 5). Else only idle interrupt
+    if (status & 0x20) {
+
+      // pass byte to attached function, e.g. protocol handler
+      if (pDesc->pRxFct != NULL)
+        pDesc->pRxFct(data);
+
+      // store byte if buffer has space
+      else {
+        head = pDesc->rx.head;
+        if ((uint8_t) (head - pDesc->rx.tail) <= pDesc->rx.mask) {
+          pDesc->rx.buf[head & pDesc->rx.mask] = data;
+          pDesc->rx.head = head + 1;
+        }
+        else
+          pDesc->rx.overflow++;
+      }
+
+    } // RXNE
+
+    // idle line after burst (IDLE = bit 4) -> mark end of burst and notify
+    if ((status & 0x10) && (pDesc->pReg->CR2.reg.ILIEN)) {
+      pDesc->idleHead = pDesc->rx.head;
+      if (pDesc->pIdleFct != NULL)
+        pDesc->pIdleFct();
+    }
+
+  } // UART_RXF_handler
+
+#endif // UART_USE_BUFFER
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
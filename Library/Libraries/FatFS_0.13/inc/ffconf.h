@@ -8,6 +8,9 @@
 / Function Configurations
 /---------------------------------------------------------------------------*/
 
+// GSIK patch: allow user configurable configuration via config.h
+#include "config.h"
+
 #define FF_FS_READONLY	0
 /* This option switches read-only configuration. (0:Read/Write or 1:Read-only)
 /  Read-only configuration removes writing API functions, f_write(), f_sync(),
@@ -46,8 +49,11 @@
 /* This option switches fast seek function. (0:Disable or 1:Enable) */
 
 
-#define FF_USE_EXPAND	0
-/* This option switches f_expand function. (0:Disable or 1:Enable) */
+#if !defined(FF_USE_EXPAND)  // GSIK patch
+  #define FF_USE_EXPAND	0
+#endif
+/* This option switches f_expand function. (0:Disable or 1:Enable)
+/  GSIK patch: also enables streaming via f_stream_open() etc. */
 
 
 #define FF_USE_CHMOD	0
@@ -15,6 +15,13 @@ extern "C" {
 /* Status of Disk Functions */
 typedef BYTE	DSTATUS;
 
+/* Sector cache statistics (MMC_GET_CACHE) */
+typedef struct {
+	DWORD	hits;		/* Single sector accesses served from cache */
+	DWORD	misses;		/* Single sector accesses which required a cache line */
+	DWORD	flushes;	/* Dirty cache lines written back to card */
+} DCACHE_STAT;
+
 /* Results of Disk Functions */
 typedef enum {
 	RES_OK = 0,		/* 0: Successful */
@@ -35,6 +42,9 @@ DSTATUS disk_status (BYTE pdrv);
 DRESULT disk_read (BYTE pdrv, BYTE* buff, DWORD sector, UINT count);
 DRESULT disk_write (BYTE pdrv, const BYTE* buff, DWORD sector, UINT count);
 DRESULT disk_ioctl (BYTE pdrv, BYTE cmd, void* buff);
+DRESULT disk_stream_open (BYTE pdrv, DWORD sector, DWORD count);
+DRESULT disk_stream_write (BYTE pdrv, const BYTE* buff);
+DRESULT disk_stream_close (BYTE pdrv);
 
 
 /* Disk Status Bits (DSTATUS) */
@@ -70,6 +80,8 @@ DRESULT disk_ioctl (BYTE pdrv, BYTE cmd, void* buff);
 #define ISDIO_READ			55	/* Read data form SD iSDIO register */
 #define ISDIO_WRITE			56	/* Write data to SD iSDIO register */
 #define ISDIO_MRITE			57	/* Masked write data to SD iSDIO register */
+#define MMC_GET_CACHE		58	/* Get sector cache statistics (DCACHE_STAT), see SD_CACHE_SECTORS (GSIK patch) */
+#define MMC_CLR_CACHE		59	/* Reset sector cache statistics (GSIK patch) */
 
 /* ATA/CF specific command (Not used by FatFs) */
 #define ATA_GET_REV			60	/* Get F/W revision */
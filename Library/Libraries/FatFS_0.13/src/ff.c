@@ -5418,6 +5418,107 @@ FRESULT f_expand (
 	LEAVE_FF(fs, res);
 }
 
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Start Sector Stream to a Contiguous Block (GSIK patch)                */
+/*-----------------------------------------------------------------------*/
+/* For fast logging: allocate a contiguous block and write sectors as one
+/  open-ended CMD25 stream, i.e. w/o command overhead per sector. The size
+/  is rounded up to whole sectors, f_stream_close() truncates the file to
+/  the written size. Until then no other function may access the volume */
+
+FRESULT f_stream_open (
+	FIL* fp,		/* Pointer to the file object (new, opened with FA_WRITE) */
+	FSIZE_t fsz		/* Max. file size to be allocated, rounded up to whole sectors */
+)
+{
+	FRESULT res;
+	FATFS *fs;
+	DWORD sect;
+
+
+	res = validate(&fp->obj, &fs);	/* Check validity of the file object */
+	if (res != FR_OK) return res;
+	fsz = (fsz + SS(fs) - 1) / SS(fs) * SS(fs);	/* Round up to whole sectors, i.e. last partial sector can be streamed */
+	res = f_expand(fp, fsz, 1);		/* Allocate a contiguous block */
+	if (res == FR_OK) res = f_sync(fp);	/* Commit FAT and directory entry before card is blocked */
+	if (res != FR_OK) return res;
+
+	sect = clst2sect(fs, fp->obj.sclust);	/* Raw LBA of first sector */
+	if (sect == 0) return FR_INT_ERR;
+	fp->fptr = 0;
+	fp->sect = sect;
+	if (disk_stream_open(fs->pdrv, sect, (DWORD)(fsz / SS(fs))) != RES_OK) return FR_DISK_ERR;
+
+	return FR_OK;
+}
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Write one Sector to the Stream (GSIK patch)                           */
+/*-----------------------------------------------------------------------*/
+
+FRESULT f_stream_write (
+	FIL* fp,			/* Pointer to the file object */
+	const void* buff	/* Pointer to one sector of data */
+)
+{
+	FATFS *fs = fp->obj.fs;
+
+
+	if (fp->err != FR_OK) return (FRESULT)fp->err;
+	if (fp->fptr + SS(fs) > fp->obj.objsize) return FR_DENIED;	/* Allocated block is full */
+
+	if (disk_stream_write(fs->pdrv, (const BYTE*)buff) != RES_OK) ABORT(fs, FR_DISK_ERR);
+	fp->fptr += SS(fs);
+	fp->sect++;
+
+	return FR_OK;
+}
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Stop the Stream and Truncate File to Written Size (GSIK patch)        */
+/*-----------------------------------------------------------------------*/
+
+FRESULT f_stream_close (
+	FIL* fp		/* Pointer to the file object */
+)
+{
+	FRESULT res;
+	FATFS *fs;
+	DWORD csz, ncl;
+
+
+	res = validate(&fp->obj, &fs);	/* Check validity of the file object */
+	if (res != FR_OK) return res;
+	if (disk_stream_close(fs->pdrv) != RES_OK) fp->err = FR_DISK_ERR;	/* Stop stream, but free unused clusters anyway */
+
+	csz = (DWORD)fs->csize * SS(fs);	/* Cluster size [B] */
+	ncl = (DWORD)((fp->fptr + csz - 1) / csz);	/* Number of clusters used */
+	if (ncl == 0) {					/* Nothing written: remove the entire chain */
+		res = remove_chain(&fp->obj, fp->obj.sclust, 0);
+		fp->obj.sclust = 0;
+		fp->clust = 0;
+	} else {
+		if (ncl < (DWORD)((fp->obj.objsize + csz - 1) / csz)) {	/* Remove unused clusters */
+			res = remove_chain(&fp->obj, fp->obj.sclust + ncl, fp->obj.sclust + ncl - 1);
+		}
+		fp->clust = fp->obj.sclust + ncl - 1;	/* Chain is contiguous. Allows further f_write() */
+	}
+	fp->sect = 0;
+	fp->obj.objsize = fp->fptr;
+	fp->flag |= FA_MODIFIED;
+	if (res == FR_OK) res = f_sync(fp);
+	if (res == FR_OK && fp->err != FR_OK) res = (FRESULT)fp->err;
+
+	return res;
+}
+
 #endif /* FF_USE_EXPAND && !FF_FS_READONLY */
 
 
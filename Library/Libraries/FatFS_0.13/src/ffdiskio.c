@@ -15,6 +15,16 @@
   * Easy to Port Bit-banging SPI
     It uses only four GPIO pins. No complex peripheral needs to be used.
 
+  * Optional STM8 Hardware SPI (#define USE_SD_HW_SPI in config.h)
+    Card initialization at <=400kHz, data transfer at f_CPU/2. Only CS pin
+    macros are required. Bus can be shared with other SPI slaves (see spi_select())
+
+  * Optional Write-Back Sector Cache (#define SD_CACHE_SECTORS 2..4 in config.h)
+    Single sector accesses (FAT, directory, FF_FS_TINY window) are cached
+    with LRU replacement, using 512B RAM per sector. Dirty sectors are written
+    on replacement or CTRL_SYNC, i.e. f_sync() and f_close(). Statistics via
+    disk_ioctl(MMC_GET_CACHE)
+
   * Platform Independent
     You need to modify only a few macros to control the GPIO port.
 
@@ -36,6 +46,7 @@
 /*-------------------------------------------------------------------------*/
 
 #include <stdio.h>
+#include <string.h>
 #include "config.h"
 #include "stm8as.h"
 #include "gpio.h"
@@ -43,15 +54,34 @@
 #include "misc.h"
 
 
+#if defined(USE_SD_HW_SPI)
+  #include "clock.h"
+  #include "spi.h"
+#endif
+
+
+#if !defined(SD_CACHE_SECTORS)
+  #define SD_CACHE_SECTORS	0		/* Number of cached sectors (0: no cache) */
+#endif
+#if SD_CACHE_SECTORS > 8
+  #error SD_CACHE_SECTORS must be in range 0..8
+#endif
+
+
 #define dly_us(n)	  sw_delayMicroseconds(n)	/* Delay n microseconds */
 
 #define	CS_H()		(SPI_SD_CSN = 1)  /* Set MMC CS "high" */
 #define CS_L()		(SPI_SD_CSN = 0)  /* Set MMC CS "low" */
-#define CK_H()		(SPI_SCK = 1)     /* Set MMC SCLK "high" */
-#define	CK_L()		(SPI_SCK = 0)     /* Set MMC SCLK "low" */
-#define DI_H()		(SPI_MOSI = 1)    /* Set MMC DI "high" */
-#define DI_L()		(SPI_MOSI = 0)    /* Set MMC DI "low" */
-#define DO			  (SPI_MISO)        /* Test MMC DO (high:true, low:false) */
+#if defined(USE_SD_HW_SPI)
+  #define	CK_L()							/* SCLK is controlled by SPI */
+  #define SD_SPI_INIT		400000L		/* max. SCLK [Hz] during card initialization */
+#else
+  #define CK_H()		(SPI_SCK = 1)     /* Set MMC SCLK "high" */
+  #define	CK_L()		(SPI_SCK = 0)     /* Set MMC SCLK "low" */
+  #define DI_H()		(SPI_MOSI = 1)    /* Set MMC DI "high" */
+  #define DI_L()		(SPI_MOSI = 0)    /* Set MMC DI "low" */
+  #define DO			  (SPI_MISO)        /* Test MMC DO (high:true, low:false) */
+#endif
 
 
 /*--------------------------------------------------------------------------
@@ -90,7 +120,134 @@ DSTATUS Stat = STA_NOINIT;	/* Disk status */
 static
 BYTE CardType;			/* b0:MMC, b1:SDv1, b2:SDv2, b3:Block addressing */
 
+static
+BYTE Streaming;			/* 1: open-ended CMD25 in progress, see disk_stream_open() */
+
+#if SD_CACHE_SECTORS
+typedef struct {
+	DWORD	sector;		/* Cached sector number (LBA) */
+	BYTE	flag;		/* b0:valid, b1:dirty */
+	BYTE	age;		/* LRU order (0:most recently used) */
+	BYTE	buf[512];	/* Sector data */
+} CACHE_LINE;
+
+static
+CACHE_LINE Cache[SD_CACHE_SECTORS];	/* Write-back sector cache */
+
+static
+DCACHE_STAT CacheStat;	/* Cache statistics */
+
+#define CACHE_VALID	0x01
+#define CACHE_DIRTY	0x02
+#endif
+
+#if defined(USE_SD_HW_SPI)
+static
+spi_profile_t SpiSD;	/* SPI settings for SD card (slow during init, then f_CPU/2) */
+#endif
+
+
+
+#if defined(USE_SD_HW_SPI)
+
+/*-----------------------------------------------------------------------*/
+/* Transmit bytes to the card (hardware SPI)                             */
+/*-----------------------------------------------------------------------*/
+
+static
+void xmit_mmc (
+	const BYTE* buff,	/* Data to be sent */
+	UINT bc				/* Number of bytes to send */
+)
+{
+	spi_write(bc, (BYTE*) buff);	/* Keep TX buffer filled, discard received data */
+}
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Receive bytes from the card (hardware SPI)                            */
+/*-----------------------------------------------------------------------*/
+
+static
+void rcvr_mmc (
+	BYTE *buff,	/* Pointer to read buffer */
+	UINT bc		/* Number of bytes to receive */
+)
+{
+	/* Send next 0xFF only after previous byte was read. Is slightly slower than
+	   pipelining, but an interrupt (e.g. 1ms tick) cannot cause an overrun */
+	do {
+		SPI.DR.byte = 0xFF;
+		while (!(SPI.SR.byte & 0x01));	/* Wait for RXNE */
+		*buff++ = SPI.DR.byte;
+	} while (--bc);
+}
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Transmit a 512 byte sector to the card (hardware SPI, unrolled)       */
+/*-----------------------------------------------------------------------*/
+
+static
+void xmit_sector (
+	const BYTE* buff	/* 512 byte data block to be sent */
+)
+{
+	BYTE n, d;
+
+
+	n = 128;
+	do {						/* Keep TX buffer filled, 4 bytes per loop */
+		while (!(SPI.SR.byte & 0x02));	/* Wait for TXE */
+		SPI.DR.byte = *buff++;
+		while (!(SPI.SR.byte & 0x02));
+		SPI.DR.byte = *buff++;
+		while (!(SPI.SR.byte & 0x02));
+		SPI.DR.byte = *buff++;
+		while (!(SPI.SR.byte & 0x02));
+		SPI.DR.byte = *buff++;
+	} while (--n);
+
+	while (SPI.SR.reg.BSY);		/* Wait until last byte is sent */
+	d = SPI.DR.byte;			/* Clear RXNE and OVR (read DR, then SR) */
+	d = SPI.SR.byte;
+	(void) d;
+}
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Receive a 512 byte sector from the card (hardware SPI, unrolled)      */
+/*-----------------------------------------------------------------------*/
+
+static
+void rcvr_sector (
+	BYTE *buff	/* Pointer to 512 byte read buffer */
+)
+{
+	BYTE n;
+
+
+	n = 128;
+	do {						/* Same as rcvr_mmc(), 4 bytes per loop */
+		SPI.DR.byte = 0xFF;
+		while (!(SPI.SR.byte & 0x01));	/* Wait for RXNE */
+		*buff++ = SPI.DR.byte;
+		SPI.DR.byte = 0xFF;
+		while (!(SPI.SR.byte & 0x01));
+		*buff++ = SPI.DR.byte;
+		SPI.DR.byte = 0xFF;
+		while (!(SPI.SR.byte & 0x01));
+		*buff++ = SPI.DR.byte;
+		SPI.DR.byte = 0xFF;
+		while (!(SPI.SR.byte & 0x01));
+		*buff++ = SPI.DR.byte;
+	} while (--n);
+}
 
+#else // USE_SD_HW_SPI
 
 /*-----------------------------------------------------------------------*/
 /* Transmit bytes to the card (bitbanging)                               */
@@ -164,6 +321,11 @@ void rcvr_mmc (
 	} while (--bc);
 }
 
+#define xmit_sector(buff)		xmit_mmc(buff, 512)
+#define rcvr_sector(buff)		rcvr_mmc(buff, 512)
+
+#endif // USE_SD_HW_SPI
+
 
 
 /*-----------------------------------------------------------------------*/
@@ -199,6 +361,9 @@ void deselect (void)
 
 	CS_H();				/* Set CS# high */
 	rcvr_mmc(&d, 1);	/* Dummy clock (force DO hi-z for multiple slave SPI) */
+#if defined(USE_SD_HW_SPI)
+	spi_deselect();		/* Release SPI for other slaves */
+#endif
 }
 
 
@@ -212,6 +377,9 @@ int select (void)	/* 1:OK, 0:Timeout */
 {
 	BYTE d;
 
+#if defined(USE_SD_HW_SPI)
+	spi_select(&SpiSD);	/* Apply SD card SPI settings, if changed by other slave */
+#endif
 	CS_L();				/* Set CS# low */
 	rcvr_mmc(&d, 1);	/* Dummy clock (force DO enabled) */
 	if (wait_ready()) return 1;	/* Wait for card ready */
@@ -243,7 +411,10 @@ int rcvr_datablock (	/* 1:OK, 0:Failed */
 	}
 	if (d[0] != 0xFE) return 0;		/* If not valid data token, return with error */
 
-	rcvr_mmc(buff, btr);			/* Receive the data block into buffer */
+	if (btr == 512)
+		rcvr_sector(buff);			/* Receive the sector into buffer (fast) */
+	else
+		rcvr_mmc(buff, btr);		/* Receive the data block into buffer */
 	rcvr_mmc(d, 2);					/* Discard CRC */
 
 	return 1;						/* Return with success */
@@ -269,7 +440,7 @@ int xmit_datablock (	/* 1:OK, 0:Failed */
 	d[0] = token;
 	xmit_mmc(d, 1);				/* Xmit a token */
 	if (token != 0xFD) {		/* Is it data token? */
-		xmit_mmc(buff, 512);	/* Xmit the 512 byte data block to MMC */
+		xmit_sector(buff);		/* Xmit the 512 byte data block to MMC */
 		rcvr_mmc(d, 2);			/* Xmit dummy CRC (0xFF,0xFF) */
 		rcvr_mmc(d, 1);			/* Receive data response */
 		if ((d[0] & 0x1F) != 0x05)	/* If not accepted, return with error */
@@ -425,6 +596,9 @@ DSTATUS disk_initialize (
 	BYTE n, ty, cmd, buf[4];
 	UINT tmr;
 	DSTATUS s;
+#if defined(USE_SD_HW_SPI)
+	BYTE pre;
+#endif
 
 
 	if (drv) return RES_NOTRDY;
@@ -433,6 +607,11 @@ DSTATUS disk_initialize (
 	CS_H();		/* Initialize port pin tied to CS */
 	CK_L();		/* Initialize port pin tied to SCLK */
 	INIT_PORT();
+#if defined(USE_SD_HW_SPI)
+	for (pre = 0; (pre < 7) && ((CLK_getMaster() >> (pre+1)) > SD_SPI_INIT); pre++);	/* SCLK <= 400kHz */
+	spi_initProfile(&SpiSD, SPI_4_WIRE, pre, MSBFIRST, SPI_MODE0, NULL, 0);
+	spi_select(&SpiSD);
+#endif
 	
 	for (n = 10; n; n--) rcvr_mmc(buf, 1);	/* Apply 80 dummy clocks and the card gets ready to receive command */
 
@@ -467,8 +646,17 @@ DSTATUS disk_initialize (
 	CardType = ty;
 	s = ty ? 0 : STA_NOINIT;
 	Stat = s;
+#if SD_CACHE_SECTORS
+	for (n = 0; n < SD_CACHE_SECTORS; n++) {	/* Discard cache of previous card */
+		Cache[n].flag = 0;
+		Cache[n].age = n;
+	}
+#endif
 
 	deselect();
+#if defined(USE_SD_HW_SPI)
+	if (ty) spi_initProfile(&SpiSD, SPI_4_WIRE, 0, MSBFIRST, SPI_MODE0, NULL, 0);	/* SCLK = f_CPU/2 */
+#endif
 
 	return s;
 }
@@ -479,7 +667,12 @@ DSTATUS disk_initialize (
 /* Read Sector(s)                                                        */
 /*-----------------------------------------------------------------------*/
 
-DRESULT disk_read (
+#if SD_CACHE_SECTORS
+static
+#else
+#define mmc_read	disk_read	/* No cache: access card directly */
+#endif
+DRESULT mmc_read (
 	BYTE drv,			/* Physical drive nmuber (0) */
 	BYTE *buff,			/* Pointer to the data buffer to store read data */
 	DWORD sector,		/* Start sector number (LBA) */
@@ -490,6 +683,7 @@ DRESULT disk_read (
 
 
 	if (disk_status(drv) & STA_NOINIT) return RES_NOTRDY;
+	if (Streaming) return RES_NOTRDY;			/* Card is busy with stream */
 	if (!(CardType & CT_BLOCK)) sector *= 512;	/* Convert LBA to byte address if needed */
 
 	cmd = count > 1 ? CMD18 : CMD17;			/*  READ_MULTIPLE_BLOCK : READ_SINGLE_BLOCK */
@@ -511,7 +705,12 @@ DRESULT disk_read (
 /* Write Sector(s)                                                       */
 /*-----------------------------------------------------------------------*/
 
-DRESULT disk_write (
+#if SD_CACHE_SECTORS
+static
+#else
+#define mmc_write	disk_write	/* No cache: access card directly */
+#endif
+DRESULT mmc_write (
 	BYTE drv,			/* Physical drive nmuber (0) */
 	const BYTE *buff,	/* Pointer to the data to be written */
 	DWORD sector,		/* Start sector number (LBA) */
@@ -519,6 +718,7 @@ DRESULT disk_write (
 )
 {
 	if (disk_status(drv) & STA_NOINIT) return RES_NOTRDY;
+	if (Streaming) return RES_NOTRDY;			/* Card is busy with stream */
 	if (!(CardType & CT_BLOCK)) sector *= 512;	/* Convert LBA to byte address if needed */
 
 	if (count == 1) {	/* Single block write */
@@ -543,6 +743,258 @@ DRESULT disk_write (
 }
 
 
+
+#if SD_CACHE_SECTORS
+/*-----------------------------------------------------------------------*/
+/* Sector cache - Write back all dirty sectors                           */
+/*-----------------------------------------------------------------------*/
+
+static
+DRESULT cache_flush (
+	BYTE drv			/* Physical drive nmuber (0) */
+)
+{
+	CACHE_LINE *cl;
+	BYTE i;
+
+
+	for (i = 0, cl = Cache; i < SD_CACHE_SECTORS; i++, cl++) {
+		if (cl->flag & CACHE_DIRTY) {
+			if (mmc_write(drv, cl->buf, cl->sector, 1) != RES_OK) return RES_ERROR;
+			cl->flag &= ~CACHE_DIRTY;
+			CacheStat.flushes++;
+		}
+	}
+
+	return RES_OK;
+}
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Sector cache - Get cache line of a sector                             */
+/*   On miss the least recently used line is replaced (written back if   */
+/*   dirty) and marked invalid. Returns 0 on write-back error            */
+/*-----------------------------------------------------------------------*/
+
+static
+CACHE_LINE* cache_line (
+	BYTE drv,			/* Physical drive nmuber (0) */
+	DWORD sector		/* Sector number (LBA) */
+)
+{
+	CACHE_LINE *cl, *hit;
+	BYTE i, age;
+
+
+	/* Look up sector */
+	for (i = 0, hit = Cache; i < SD_CACHE_SECTORS; i++, hit++) {
+		if ((hit->flag & CACHE_VALID) && hit->sector == sector) break;
+	}
+	if (i < SD_CACHE_SECTORS) {
+		CacheStat.hits++;
+	} else {		/* Miss: replace invalid or least recently used line */
+		CacheStat.misses++;
+		for (i = 0, cl = hit = Cache; i < SD_CACHE_SECTORS; i++, cl++) {
+			if (!(cl->flag & CACHE_VALID)) {
+				hit = cl;
+				break;
+			}
+			if (cl->age > hit->age) hit = cl;
+		}
+		if (hit->flag & CACHE_DIRTY) {	/* Write back replaced sector */
+			if (mmc_write(drv, hit->buf, hit->sector, 1) != RES_OK) return 0;
+			CacheStat.flushes++;
+		}
+		hit->flag = 0;
+		hit->sector = sector;
+	}
+
+	/* Update LRU order */
+	age = hit->age;
+	for (i = 0, cl = Cache; i < SD_CACHE_SECTORS; i++, cl++) {
+		if (cl->age < age) cl->age++;
+	}
+	hit->age = 0;
+
+	return hit;
+}
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Read Sector(s) via cache                                              */
+/*-----------------------------------------------------------------------*/
+
+DRESULT disk_read (
+	BYTE drv,			/* Physical drive nmuber (0) */
+	BYTE *buff,			/* Pointer to the data buffer to store read data */
+	DWORD sector,		/* Start sector number (LBA) */
+	UINT count			/* Sector count (1..128) */
+)
+{
+	CACHE_LINE *cl;
+	BYTE i;
+	DRESULT res;
+
+
+	if (disk_status(drv) & STA_NOINIT) return RES_NOTRDY;
+	if (Streaming) return RES_NOTRDY;			/* Card is busy with stream */
+
+	if (count == 1) {	/* Single sector: read via cache */
+		cl = cache_line(drv, sector);
+		if (!cl) return RES_ERROR;
+		if (!(cl->flag & CACHE_VALID)) {
+			res = mmc_read(drv, cl->buf, sector, 1);
+			if (res != RES_OK) return res;
+			cl->flag = CACHE_VALID;
+		}
+		memcpy(buff, cl->buf, 512);
+		return RES_OK;
+	}
+
+	/* Multiple sectors: read from card, then apply newer data from cache */
+	res = mmc_read(drv, buff, sector, count);
+	if (res != RES_OK) return res;
+	for (i = 0, cl = Cache; i < SD_CACHE_SECTORS; i++, cl++) {
+		if ((cl->flag & CACHE_DIRTY) && cl->sector >= sector && cl->sector < sector + count)
+			memcpy(buff + (UINT)(cl->sector - sector) * 512, cl->buf, 512);
+	}
+
+	return RES_OK;
+}
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Write Sector(s) via cache                                             */
+/*-----------------------------------------------------------------------*/
+
+DRESULT disk_write (
+	BYTE drv,			/* Physical drive nmuber (0) */
+	const BYTE *buff,	/* Pointer to the data to be written */
+	DWORD sector,		/* Start sector number (LBA) */
+	UINT count			/* Sector count (1..128) */
+)
+{
+	CACHE_LINE *cl;
+	BYTE i;
+
+
+	if (disk_status(drv) & STA_NOINIT) return RES_NOTRDY;
+	if (Streaming) return RES_NOTRDY;			/* Card is busy with stream, don't touch cache */
+
+	if (count == 1) {	/* Single sector: write back later */
+		cl = cache_line(drv, sector);
+		if (!cl) return RES_ERROR;
+		memcpy(cl->buf, buff, 512);
+		cl->flag = CACHE_VALID | CACHE_DIRTY;
+		return RES_OK;
+	}
+
+	/* Multiple sectors: write to card and drop outdated cache lines */
+	for (i = 0, cl = Cache; i < SD_CACHE_SECTORS; i++, cl++) {
+		if (cl->sector >= sector && cl->sector < sector + count) cl->flag = 0;
+	}
+
+	return mmc_write(drv, buff, sector, count);
+}
+#endif /* SD_CACHE_SECTORS */
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Start open-ended multiple block write (CMD25)                         */
+/*   Card is deselected between sectors, i.e. the SPI bus can be shared  */
+/*   with other slaves. Until disk_stream_close() all other disk         */
+/*   functions return RES_NOTRDY                                         */
+/*-----------------------------------------------------------------------*/
+
+DRESULT disk_stream_open (
+	BYTE drv,			/* Physical drive nmuber (0) */
+	DWORD sector,		/* Start sector number (LBA) */
+	DWORD count			/* Max. number of sectors (for pre-erase) */
+)
+{
+#if SD_CACHE_SECTORS
+	BYTE n;
+
+
+#endif
+	if (disk_status(drv) & STA_NOINIT) return RES_NOTRDY;
+	if (Streaming) return RES_NOTRDY;
+#if SD_CACHE_SECTORS
+	if (cache_flush(drv) != RES_OK) return RES_ERROR;	/* Streamed sectors bypass the cache */
+	for (n = 0; n < SD_CACHE_SECTORS; n++) Cache[n].flag = 0;
+#endif
+	if (!(CardType & CT_BLOCK)) sector *= 512;	/* Convert LBA to byte address if needed */
+
+	if (CardType & CT_SDC) {		/* Pre-erase hint (max. 22 bit) */
+		if (count > 0x3FFFFF) count = 0x3FFFFF;
+		send_cmd(ACMD23, count);
+	}
+	if (send_cmd(CMD25, sector) != 0) {	/* WRITE_MULTIPLE_BLOCK */
+		deselect();
+		return RES_ERROR;
+	}
+	Streaming = 1;
+	deselect();		/* Release bus. CS# may be high between data blocks */
+
+	return RES_OK;
+}
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Write next sector of open-ended multiple block write                  */
+/*-----------------------------------------------------------------------*/
+
+DRESULT disk_stream_write (
+	BYTE drv,			/* Physical drive nmuber (0) */
+	const BYTE *buff	/* Pointer to the 512 byte sector to be written */
+)
+{
+	DRESULT res;
+
+
+	if (drv || !Streaming) return RES_NOTRDY;
+
+	res = RES_ERROR;
+	if (select()) {		/* Reselect and wait until previous block is programmed */
+		if (xmit_datablock(buff, 0xFC)) res = RES_OK;
+		deselect();		/* Release bus for other slaves */
+	}
+
+	return res;
+}
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Stop open-ended multiple block write                                  */
+/*-----------------------------------------------------------------------*/
+
+DRESULT disk_stream_close (
+	BYTE drv			/* Physical drive nmuber (0) */
+)
+{
+	DRESULT res;
+
+
+	if (drv || !Streaming) return RES_NOTRDY;
+
+	res = RES_ERROR;
+	if (select()) {
+		if (xmit_datablock(0, 0xFD)) res = RES_OK;	/* STOP_TRAN token */
+		deselect();
+	}
+	Streaming = 0;
+
+	return res;
+}
+
+
+
 /*-----------------------------------------------------------------------*/
 /* Miscellaneous Functions                                               */
 /*-----------------------------------------------------------------------*/
@@ -559,13 +1011,29 @@ DRESULT disk_ioctl (
 
 
 	if (disk_status(drv) & STA_NOINIT) return RES_NOTRDY;	/* Check if card is in the socket */
+	if (Streaming) return RES_NOTRDY;						/* Card is busy with stream */
 
 	res = RES_ERROR;
 	switch (ctrl) {
 		case CTRL_SYNC :		/* Make sure that no pending write process */
+#if SD_CACHE_SECTORS
+			if (cache_flush(drv) != RES_OK) break;	/* Write back dirty sectors */
+#endif
 			if (select()) res = RES_OK;
 			break;
 
+#if SD_CACHE_SECTORS
+		case MMC_GET_CACHE :	/* Get cache statistics (DCACHE_STAT) */
+			*(DCACHE_STAT*)buff = CacheStat;
+			res = RES_OK;
+			break;
+
+		case MMC_CLR_CACHE :	/* Reset cache statistics */
+			CacheStat.hits = CacheStat.misses = CacheStat.flushes = 0;
+			res = RES_OK;
+			break;
+#endif
+
 		case GET_SECTOR_COUNT :	/* Get number of sectors on the disk (DWORD) */
 			if ((send_cmd(CMD9, 0) == 0) && rcvr_datablock(csd, 16)) {
 				if ((csd[0] >> 6) == 1) {	/* SDC ver 2.00 */
@@ -53,6 +53,10 @@ typedef struct {
 	CLUST	org_clust;	/* File start cluster */
 	CLUST	curr_clust;	/* File current cluster */
 	DWORD	dsect;		/* File current data sector */
+#if _USE_LSEEK && _LSEEK_CACHE
+	CLUST	lstride;	/* Number of file clusters between cluster link cache entries (GSIK patch) */
+	CLUST	lmap[_LSEEK_CACHE];	/* Cluster link cache: cluster# of file cluster lstride*i (0:unknown) (GSIK patch) */
+#endif
 } FATFS;
 
 
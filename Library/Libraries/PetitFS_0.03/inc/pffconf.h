@@ -12,6 +12,26 @@
 // GSIK patch: allow user configurable configuration via config.h
 #include "config.h"
 
+// GSIK patch: build profile for random read access on FAT16/FAT32 cards,
+// e.g. replay of large recordings. Define _PFF_PROFILE_SEEK32 in config.h
+#if defined(_PFF_PROFILE_SEEK32)
+  #if !defined(_USE_READ)
+    #define _USE_READ	1
+  #endif
+  #if !defined(_USE_LSEEK)
+    #define _USE_LSEEK	1
+  #endif
+  #if !defined(_FS_FAT16)
+    #define _FS_FAT16	1
+  #endif
+  #if !defined(_FS_FAT32)
+    #define _FS_FAT32	1
+  #endif
+  #if !defined(_LSEEK_CACHE)
+    #define _LSEEK_CACHE	8
+  #endif
+#endif
+
 #if !defined(_USE_READ)  // GSIK patch
   #define	_USE_READ	0	/* Enable pf_read() function */
 #endif
@@ -21,6 +41,12 @@
 #if !defined(_USE_LSEEK)  // GSIK patch
   #define	_USE_LSEEK	0	/* Enable pf_lseek() function */
 #endif
+#if !defined(_LSEEK_CACHE)  // GSIK patch
+  #define	_LSEEK_CACHE	0	/* Number of cluster links cached for pf_lseek() (0:Disable) */
+#endif
+/* With _LSEEK_CACHE = N, the cluster# of N evenly spaced clusters of the open
+/  file is remembered (N*4 bytes RAM on FAT32). pf_lseek() then follows the FAT
+/  chain from the nearest known cluster instead of the top of the file. */
 #if !defined(_USE_WRITE)  // GSIK patch
   #define	_USE_WRITE	0	/* Enable pf_write() function */
 #endif
@@ -29,6 +29,7 @@ typedef enum {
 /* Prototypes for disk control functions */
 
 void    pf_print_error(BYTE rc, BYTE halt);
+void    pf_attachForward(void (*pFct)(BYTE));	/* Set sink for pf_read(NULL,...), must not use SPI (GSIK patch) */
 DSTATUS disk_initialize (void);
 DRESULT disk_readp (BYTE* buff, DWORD sector, UINT offser, UINT count);
 DRESULT disk_writep (const BYTE* buff, DWORD sc);
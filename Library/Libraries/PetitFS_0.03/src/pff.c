@@ -391,6 +391,28 @@ CLUST get_fat (	/* 1:IO error, Else:Cluster status */
 
 
 
+#if _USE_LSEEK && _LSEEK_CACHE
+/*-----------------------------------------------------------------------*/
+/* Cluster link cache - Store cluster# of a file cluster (GSIK patch)    */
+/*-----------------------------------------------------------------------*/
+
+static
+void lmap_store (
+	DWORD idx,		/* Cluster index in the file */
+	CLUST clst		/* Cluster# */
+)
+{
+	FATFS *fs = FatFs;
+
+
+	if (idx % fs->lstride == 0 && idx / fs->lstride < _LSEEK_CACHE)
+		fs->lmap[(UINT)(idx / fs->lstride)] = clst;
+}
+#endif
+
+
+
+
 /*-----------------------------------------------------------------------*/
 /* Get sector# from cluster# / Get cluster field from directory entry    */
 /*-----------------------------------------------------------------------*/
@@ -849,6 +871,17 @@ FRESULT pf_open (
 	fs->fsize = LD_DWORD(dir+DIR_FileSize);	/* File size */
 	fs->fptr = 0;						/* File pointer */
 	fs->flag = FA_OPENED;
+#if _USE_LSEEK && _LSEEK_CACHE
+	{									/* Reset cluster link cache, spread entries over file */
+		DWORD ncl;
+		BYTE i;
+
+		ncl = fs->fsize / ((DWORD)fs->csize * 512) + 1;
+		fs->lstride = (CLUST)((ncl + _LSEEK_CACHE - 1) / _LSEEK_CACHE);
+		for (i = 0; i < _LSEEK_CACHE; i++) fs->lmap[i] = 0;
+		fs->lmap[0] = fs->org_clust;
+	}
+#endif
 
 	return FR_OK;
 }
@@ -893,6 +926,9 @@ FRESULT pf_read (
 					clst = get_fat(fs->curr_clust);
 				if (clst <= 1) ABORT(FR_DISK_ERR);
 				fs->curr_clust = clst;				/* Update current cluster */
+#if _USE_LSEEK && _LSEEK_CACHE
+				lmap_store(fs->fptr / 512 / fs->csize, clst);
+#endif
 			}
 			sect = clust2sect(fs->curr_clust);		/* Get current sector */
 			if (!sect) ABORT(FR_DISK_ERR);
@@ -993,6 +1029,10 @@ FRESULT pf_lseek (
 	CLUST clst;
 	DWORD bcs, sect, ifptr;
 	FATFS *fs = FatFs;
+#if _LSEEK_CACHE
+	DWORD cofs;
+	UINT n;
+#endif
 
 
 	if (!fs) return FR_NOT_ENABLED;		/* Check file system */
@@ -1007,18 +1047,31 @@ FRESULT pf_lseek (
 		if (ifptr > 0 &&
 			(ofs - 1) / bcs >= (ifptr - 1) / bcs) {	/* When seek to same or following cluster, */
 			fs->fptr = (ifptr - 1) & ~(bcs - 1);	/* start from the current cluster */
-			ofs -= fs->fptr;
 			clst = fs->curr_clust;
 		} else {							/* When seek to back cluster, */
 			clst = fs->org_clust;			/* start from the first cluster */
-			fs->curr_clust = clst;
 		}
+#if _LSEEK_CACHE
+		n = (UINT)((ofs - 1) / bcs / fs->lstride);	/* Nearest cached cluster before target (GSIK patch) */
+		if (n >= _LSEEK_CACHE) n = _LSEEK_CACHE - 1;
+		while (n && !fs->lmap[n]) n--;
+		cofs = (DWORD)n * fs->lstride * bcs;
+		if (cofs > fs->fptr) {				/* Start from cached cluster, if closer */
+			fs->fptr = cofs;
+			clst = fs->lmap[n];
+		}
+#endif
+		ofs -= fs->fptr;
+		fs->curr_clust = clst;
 		while (ofs > bcs) {				/* Cluster following loop */
 			clst = get_fat(clst);		/* Follow cluster chain */
 			if (clst <= 1 || clst >= fs->n_fatent) ABORT(FR_DISK_ERR);
 			fs->curr_clust = clst;
 			fs->fptr += bcs;
 			ofs -= bcs;
+#if _LSEEK_CACHE
+			lmap_store(fs->fptr / bcs, clst);
+#endif
 		}
 		fs->fptr += ofs;
 		sect = clust2sect(clst);		/* Current sector */
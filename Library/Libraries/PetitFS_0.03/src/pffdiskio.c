@@ -1,6 +1,18 @@
 /*-----------------------------------------------------------------------*/
 /* Low level disk I/O module skeleton for Petit FatFs (C)ChaN, 2014      */
 /*-----------------------------------------------------------------------*/
+/*
+  GSIK patches:
+  * Streaming read: pf_read(NULL,...) forwards file data byte by byte to a
+    sink set via pf_attachForward() (default putchar), e.g. UART, PWM or a
+    parallel port DAC. No sector buffer is required. SCLK pauses while the
+    sink blocks, which can be used for pacing, e.g. audio sample rate.
+    The sink is called in the middle of a data block with the SD card
+    selected, i.e. it must not use the SPI bus (no SPI DAC or display)
+  * Optional STM8 hardware SPI (#define USE_SD_HW_SPI in config.h).
+    Card initialization at <=400kHz, data transfer at f_CPU/2. Only CS pin
+    macros are required. Bus can be shared with other SPI slaves (see spi_select())
+*/
 
 #include "pffdiskio.h"
 
@@ -17,16 +29,26 @@
 #include "misc.h"
 
 
+#if defined(USE_SD_HW_SPI)
+  #include "clock.h"
+  #include "spi.h"
+#endif
+
+
 #define DLY_US(n)	  sw_delayMicroseconds(n)	/* Delay n microseconds */
-#define	FORWARD(d)	putchar(d)	/* Data in-time processing function (depends on the project) */
+#define	FORWARD(d)	Forward(d)	/* Data in-time processing function, see pf_attachForward() */
 
 #define	CS_H()		(SPI_SD_CSN = 1)  /* Set MMC CS "high" */
 #define CS_L()		(SPI_SD_CSN = 0)  /* Set MMC CS "low" */
-#define CK_H()		(SPI_SCK = 1)     /* Set MMC SCLK "high" */
-#define	CK_L()		(SPI_SCK = 0)     /* Set MMC SCLK "low" */
-#define DI_H()		(SPI_MOSI = 1)    /* Set MMC DI "high" */
-#define DI_L()		(SPI_MOSI = 0)    /* Set MMC DI "low" */
-#define DO			  (SPI_MISO)        /* Test MMC DO (high:true, low:false) */
+#if defined(USE_SD_HW_SPI)
+  #define SD_SPI_INIT		400000L		/* max. SCLK [Hz] during card initialization */
+#else
+  #define CK_H()		(SPI_SCK = 1)     /* Set MMC SCLK "high" */
+  #define	CK_L()		(SPI_SCK = 0)     /* Set MMC SCLK "low" */
+  #define DI_H()		(SPI_MOSI = 1)    /* Set MMC DI "high" */
+  #define DI_L()		(SPI_MOSI = 0)    /* Set MMC DI "low" */
+  #define DO			  (SPI_MISO)        /* Test MMC DO (high:true, low:false) */
+#endif
 
 
 
@@ -59,8 +81,86 @@
 static
 BYTE CardType;			/* b0:MMC, b1:SDv1, b2:SDv2, b3:Block addressing */
 
+#if defined(USE_SD_HW_SPI)
+static
+spi_profile_t SpiSD;	/* SPI settings for SD card (slow during init, then f_CPU/2) */
+#endif
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Default sink for pf_read(NULL,...)                                    */
+/*-----------------------------------------------------------------------*/
+
+static
+void forward_putchar (
+	BYTE d			/* Data to be forwarded */
+)
+{
+	putchar(d);
+}
+
+static
+void (*Forward)(BYTE) = forward_putchar;	/* Sink for pf_read(NULL,...) */
+
+
+
+#if defined(USE_SD_HW_SPI)
+
+/*-----------------------------------------------------------------------*/
+/* Transmit a byte to the MMC (hardware SPI)                             */
+/*-----------------------------------------------------------------------*/
+
+static
+void xmit_mmc (
+	BYTE d			/* Data to be sent */
+)
+{
+	SPI.DR.byte = d;
+	while (!(SPI.SR.byte & 0x01));	/* Wait for RXNE */
+	d = SPI.DR.byte;				/* Discard received byte */
+	(void) d;
+}
+
 
 
+/*-----------------------------------------------------------------------*/
+/* Receive a byte from the MMC (hardware SPI)                            */
+/*-----------------------------------------------------------------------*/
+
+static
+BYTE rcvr_mmc (void)
+{
+	SPI.DR.byte = 0xFF;				/* Send 0xFF */
+	while (!(SPI.SR.byte & 0x01));	/* Wait for RXNE */
+
+	return SPI.DR.byte;
+}
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Skip bytes on the MMC (hardware SPI)                                  */
+/*-----------------------------------------------------------------------*/
+
+static
+void skip_mmc (
+	UINT n		/* Number of bytes to skip */
+)
+{
+	BYTE d;
+
+
+	do {
+		SPI.DR.byte = 0xFF;				/* Send 0xFF */
+		while (!(SPI.SR.byte & 0x01));	/* Wait for RXNE */
+		d = SPI.DR.byte;
+	} while (--n);
+	(void) d;
+}
+
+#else // USE_SD_HW_SPI
+
 /*-----------------------------------------------------------------------*/
 /* Transmit a byte to the MMC (bitbanging)                               */
 /*-----------------------------------------------------------------------*/
@@ -147,6 +247,8 @@ void skip_mmc (
 	} while (--n);
 }
 
+#endif // USE_SD_HW_SPI
+
 
 
 /*-----------------------------------------------------------------------*/
@@ -158,6 +260,9 @@ void release_spi (void)
 {
 	CS_H();
 	rcvr_mmc();
+#if defined(USE_SD_HW_SPI)
+	spi_deselect();		/* Release SPI for other slaves */
+#endif
 }
 
 
@@ -181,6 +286,9 @@ BYTE send_cmd (
 	}
 
 	/* Select the card */
+#if defined(USE_SD_HW_SPI)
+	spi_select(&SpiSD);	/* Apply SD card SPI settings, if changed by other slave */
+#endif
 	CS_H(); rcvr_mmc();
 	CS_L(); rcvr_mmc();
 
@@ -248,6 +356,19 @@ void pf_print_error(BYTE rc, BYTE halt) {
 
 
 
+/*-----------------------------------------------------------------------*/
+/* Set sink for streaming read via pf_read(NULL,...)                     */
+/*   pFct = function called for each byte. NULL restores putchar()      */
+/*   Called while SD card is selected -> must not access SPI bus         */
+/*-----------------------------------------------------------------------*/
+void pf_attachForward(void (*pFct)(BYTE)) {
+
+	Forward = pFct ? pFct : forward_putchar;
+
+} // pf_attachForward
+
+
+
 /*-----------------------------------------------------------------------*/
 /* Initialize Disk Drive                                                 */
 /*-----------------------------------------------------------------------*/
@@ -259,6 +380,11 @@ DSTATUS disk_initialize (void)
 
 
 	INIT_PORT();
+#if defined(USE_SD_HW_SPI)
+	for (n = 0; (n < 7) && ((CLK_getMaster() >> (n+1)) > SD_SPI_INIT); n++);	/* SCLK <= 400kHz */
+	spi_initProfile(&SpiSD, SPI_4_WIRE, n, MSBFIRST, SPI_MODE0, NULL, 0);
+	spi_select(&SpiSD);
+#endif
 	CS_H();
 	skip_mmc(10);			/* Dummy clocks */
 
@@ -292,6 +418,9 @@ DSTATUS disk_initialize (void)
 	}
 	CardType = ty;
 	release_spi();
+#if defined(USE_SD_HW_SPI)
+	if (ty) spi_initProfile(&SpiSD, SPI_4_WIRE, 0, MSBFIRST, SPI_MODE0, NULL, 0);	/* SCLK = f_CPU/2 */
+#endif
 
 	return ty ? 0 : STA_NOINIT;
 }
@@ -34,7 +34,7 @@
   \param[in] ch   channel to set (0,1)
   \param[in] res  new resistor value [0..255]
   
-  \return  operation succeeded?
+  \return  error code (0=ok, see i2c.h)
    
   set resistance btw terminal A and washer ch to Rmax/255*res. Resistance btw
   terminal B and washer to Rmax/255*(255-res)
@@ -42,7 +42,7 @@
 uint8_t AD5282_set_poti(uint8_t ch, uint8_t res) {
 
   // I2C Tx buffer
-  uint8_t  buf[2], err;
+  uint8_t  buf[2];
 
   // set buffer
   if (ch == 0)
@@ -51,17 +51,12 @@ uint8_t AD5282_set_poti(uint8_t ch, uint8_t res) {
     buf[0] = 0x80;    // channel B
   buf[1] = res;       // resistance
   
-  // generate start condition (w/ timeout)
-  err  = i2c_start();
-  
-  // send command (w/ timeout)
-  err |= i2c_send(ADDR_I2C_AD5282,2,buf);    
-
-  // generate stop condition (w/ timeout)
-  err |= i2c_stop();
+  // poti known to be absent (see i2c_scan()) -> skip
+  if (!i2c_isPresent(ADDR_I2C_AD5282))
+    return(I2C_ERR_NACK_ADDR);
 
-  // return error status
-  return(err);
+  // send command incl. start & stop condition (w/ timeout)
+  return(i2c_writeRead(ADDR_I2C_AD5282, 2, buf, 0, NULL));
 
 } // AD5282_set_poti
 
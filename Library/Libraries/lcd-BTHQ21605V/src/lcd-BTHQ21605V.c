@@ -42,8 +42,9 @@
   
   \return is an LCD attached?
 
-  Reset and rnitialize LCD for output.
-  Check if LCD display is attached via bus timeout 
+  Reset and initialize LCD for output.
+  Check if LCD display is attached via I2C address ACK. If not, subsequent
+  BTHQ21605V_lcd_print() are skipped (see i2c_isPresent())
 */
 uint8_t BTHQ21605V_lcd_init(PORT_t *pPortRST, uint8_t pinRST) {
 
@@ -56,20 +57,9 @@ uint8_t BTHQ21605V_lcd_init(PORT_t *pPortRST, uint8_t pinRST) {
   pinLow(pPortRST, pinRST);
 
 
-  ////
-  // check if LCD present by sending a dummy frame
-  ////
-  
-  // generate start condition
-  i2c_start();
+  // check if LCD present. Result is stored in presence cache
+  status = i2c_probe(ADDR_I2C_BTHQ21605V);
 
-  // send dummy frame (with timeout)
-  status = (uint8_t) (i2c_send(ADDR_I2C_BTHQ21605V, 0, NULL));
-
-  // generate stop condition
-  i2c_stop();
-  
-  
   // if LCD is present clear it
   if (status) 
     BTHQ21605V_lcd_clear();
@@ -119,6 +109,10 @@ void BTHQ21605V_lcd_print(uint8_t line, uint8_t col, char *s) {
   uint8_t   len;
   uint8_t   i, j;
 
+  // LCD known to be absent -> skip to avoid bus timeouts
+  if (!i2c_isPresent(ADDR_I2C_BTHQ21605V))
+    return;
+
 
   //////
   // config display
@@ -0,0 +1,98 @@
+/**
+  \file sdLogger.h
+
+  \author G. Icking-Konert
+  \date 2026-10-17
+  \version 0.1
+
+  \brief declaration of double-buffered data logger on FatFS
+
+  declaration of functions for continuous logging to an SD card via FatFS.
+  Samples are appended from ISR (e.g. 1ms interrupt) to one of two 512B RAM
+  sectors, while the main loop writes the other, full sector to file.
+  A sample is never split by dropping: if it doesn't fit into the free
+  buffer space, it is discarded completely and counted. While a full sector
+  waits for write, the other sector accepts at most 511B, i.e. a sample
+  exactly filling it is dropped instead of overwriting the pending sector.
+  The file is synchronized (directory entry, FAT) every N sectors. Smaller
+  N reduces data loss on power fail, larger N increases throughput.
+  Typical usage:
+    - open file via f_open(), then call sdlog_begin()
+    - from ISR call sdlog_write() for each sample
+    - from main loop call sdlog_task() continuously
+    - to stop call sdlog_end(), then f_close()
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _SDLOGGER_H_
+#define _SDLOGGER_H_
+
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include <stdint.h>
+#include "stm8as.h"
+#include "config.h"
+#include "ff.h"
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL MACROS
+-----------------------------------------------------------------------------*/
+
+/// size of one buffer [B]. Must be sector size for direct write w/o FatFS buffer
+#define SDLOG_SECTOR          512
+
+/// check if logger is running, i.e. sdlog_begin() called and no write error
+#define sdlog_isActive()      (g_sdlog_active)
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL TYPEDEFS
+-----------------------------------------------------------------------------*/
+
+/** logger statistics (sdlog_stats_t). Read via sdlog_getStats() */
+typedef struct {
+  uint32_t    numSamples;     ///< samples stored in buffer
+  uint32_t    numDropped;     ///< samples dropped due to full buffers or inactive logger
+  uint32_t    numSectors;     ///< sectors written to file
+  uint16_t    numSync;        ///< number of f_sync() calls
+  uint8_t     err;            ///< last FatFS error (0=ok). Logger stops on error
+} sdlog_stats_t;
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL VARIABLES
+-----------------------------------------------------------------------------*/
+
+/// logger running. Defined in sdLogger.c
+extern volatile uint8_t   g_sdlog_active;
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/// start logging to opened file. f_sync() every numSync sectors (0=only at end)
+void      sdlog_begin(FIL *fp, uint16_t numSync);
+
+/// append sample to buffer. Can be called from ISR. Return 1 if sample was dropped
+uint8_t   sdlog_write(const uint8_t *data, uint8_t len);
+
+/// write full sector to file, if any. Call continuously from main loop. Return FatFS error
+uint8_t   sdlog_task(void);
+
+/// stop logging, write remaining data and sync file. Return FatFS error
+uint8_t   sdlog_end(void);
+
+/// get copy of logger statistics
+void      sdlog_getStats(sdlog_stats_t *pStats);
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif  // _SDLOGGER_H_
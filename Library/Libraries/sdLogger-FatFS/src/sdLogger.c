@@ -0,0 +1,302 @@
+/**
+  \file sdLogger.c
+
+  \author G. Icking-Konert
+  \date 2026-10-17
+  \version 0.1
+
+  \brief implementation of double-buffered data logger on FatFS
+
+  implementation of functions for continuous logging to an SD card via FatFS.
+  For details see sdLogger.h
+*/
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include <stdint.h>
+#include "stm8as.h"
+#include "misc.h"
+#include "ff.h"
+#include "sdLogger.h"
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF MODULE VARIABLES
+-----------------------------------------------------------------------------*/
+
+volatile uint8_t          g_sdlog_active = 0;                     ///< logger running
+
+static sdlog_stats_t      m_sdlog_stats;                          ///< statistics
+static FIL                *m_sdlog_fp;                            ///< log file
+static uint16_t           m_sdlog_numSync;                        ///< f_sync() every N sectors (0=only at end)
+static uint16_t           m_sdlog_cntSync;                        ///< sectors since last f_sync()
+
+static uint8_t            m_sdlog_buf[2][SDLOG_SECTOR];           ///< double buffer
+static volatile uint8_t   m_sdlog_fill;                           ///< index of buffer being filled
+static volatile uint16_t  m_sdlog_idx;                            ///< number of bytes in buffer being filled
+static volatile uint8_t   m_sdlog_pending;                        ///< other buffer is full and waits for write
+
+
+/*----------------------------------------------------------
+    MODULE FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn uint8_t sdlog_stop(uint8_t err)
+
+  \brief stop logger on FatFS error
+
+  \param[in]  err     FatFS error code
+
+  \return  FatFS error code (=err)
+*/
+static uint8_t sdlog_stop(uint8_t err) {
+
+  if (err) {
+    g_sdlog_active = 0;
+    m_sdlog_stats.err = err;
+  }
+
+  return(err);
+
+} // sdlog_stop
+
+
+
+/**
+  \fn uint8_t sdlog_writeFile(uint8_t *buf, uint16_t num)
+
+  \brief write buffer to file and sync according to policy
+
+  \param[in]  buf     data to write
+  \param[in]  num     number of bytes
+
+  \return  FatFS error code (0=ok)
+*/
+static uint8_t sdlog_writeFile(uint8_t *buf, uint16_t num) {
+
+  FRESULT   res;
+  UINT      bw;
+
+  // write data. Full sectors at sector boundary are written directly by FatFS
+  res = f_write(m_sdlog_fp, buf, num, &bw);
+  if ((res == FR_OK) && (bw != num))
+    res = FR_DENIED;                  // disk full
+  if (res != FR_OK)
+    return(sdlog_stop((uint8_t) res));
+  m_sdlog_stats.numSectors++;
+
+  // sync file every N sectors
+  if ((m_sdlog_numSync != 0) && (++m_sdlog_cntSync >= m_sdlog_numSync)) {
+    m_sdlog_cntSync = 0;
+    m_sdlog_stats.numSync++;
+    res = f_sync(m_sdlog_fp);
+  }
+
+  return(sdlog_stop((uint8_t) res));
+
+} // sdlog_writeFile
+
+
+
+/*----------------------------------------------------------
+    GLOBAL FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn void sdlog_begin(FIL *fp, uint16_t numSync)
+
+  \brief start logging
+
+  \param[in]  fp        file opened for write via f_open()
+  \param[in]  numSync   f_sync() every N sectors (0=only in sdlog_end())
+
+  reset buffers and statistics and start logging to file. For direct sector
+  writes w/o FatFS buffer, the file pointer should be at a sector boundary,
+  e.g. new file
+*/
+void sdlog_begin(FIL *fp, uint16_t numSync) {
+
+  // stop ISR access during reset
+  g_sdlog_active = 0;
+
+  // store parameters
+  m_sdlog_fp      = fp;
+  m_sdlog_numSync = numSync;
+  m_sdlog_cntSync = 0;
+
+  // reset buffers
+  m_sdlog_fill    = 0;
+  m_sdlog_idx     = 0;
+  m_sdlog_pending = 0;
+
+  // reset statistics
+  m_sdlog_stats.numSamples = 0;
+  m_sdlog_stats.numDropped = 0;
+  m_sdlog_stats.numSectors = 0;
+  m_sdlog_stats.numSync    = 0;
+  m_sdlog_stats.err        = 0;
+
+  // start logger
+  g_sdlog_active = 1;
+
+} // sdlog_begin
+
+
+
+/**
+  \fn uint8_t sdlog_write(const uint8_t *data, uint8_t len)
+
+  \brief append sample to buffer
+
+  \param[in]  data    sample data
+  \param[in]  len     sample size [B]
+
+  \return  1 if sample was dropped, else 0
+
+  append sample to current buffer. If buffer is full, continue in other buffer
+  and mark full buffer for sdlog_task(). If the sample doesn't fit into the free
+  space, i.e. main loop is too slow, it is dropped completely and counted.
+  Note: while the other buffer is pending, the current buffer must not become
+  full, else the fill index would switch to the buffer being written. Then a
+  sample exactly filling the buffer (e.g. 6B samples) is dropped as well.
+  Is short enough to be called from ISR. Must not be interrupted by itself
+*/
+uint8_t sdlog_write(const uint8_t *data, uint8_t len) {
+
+  uint8_t   *p;
+  uint16_t  idx, space;
+
+  // get free space. Other buffer is free if not pending. If pending, keep
+  // one byte free to avoid a buffer switch onto the buffer being written
+  idx = m_sdlog_idx;
+  space = SDLOG_SECTOR - idx;
+  if (!m_sdlog_pending)
+    space += SDLOG_SECTOR;
+  else
+    space--;
+
+  // logger stopped or not enough space -> drop complete sample
+  if ((!g_sdlog_active) || (len > space)) {
+    m_sdlog_stats.numDropped++;
+    return(1);
+  }
+
+  // copy sample. On full buffer switch to other one (is free, see above)
+  p = &(m_sdlog_buf[m_sdlog_fill][idx]);
+  while (len--) {
+    *(p++) = *(data++);
+    if (++idx == SDLOG_SECTOR) {
+      m_sdlog_pending = 1;
+      m_sdlog_fill ^= 1;
+      p = &(m_sdlog_buf[m_sdlog_fill][0]);
+      idx = 0;
+    }
+  }
+  m_sdlog_idx = idx;
+  m_sdlog_stats.numSamples++;
+
+  return(0);
+
+} // sdlog_write
+
+
+
+/**
+  \fn uint8_t sdlog_task(void)
+
+  \brief write full buffer to file
+
+  \return  FatFS error code (0=ok)
+
+  if a buffer is full, write it to file and sync according to policy.
+  Meanwhile the ISR fills the other buffer. Call continuously from
+  main loop. On error logger is stopped
+*/
+uint8_t sdlog_task(void) {
+
+  uint8_t   err;
+
+  // nothing to do
+  if (!m_sdlog_pending)
+    return(0);
+
+  // write full buffer. Is not touched by ISR while pending
+  err = sdlog_writeFile(m_sdlog_buf[m_sdlog_fill ^ 1], SDLOG_SECTOR);
+
+  // release buffer for ISR
+  m_sdlog_pending = 0;
+
+  return(err);
+
+} // sdlog_task
+
+
+
+/**
+  \fn uint8_t sdlog_end(void)
+
+  \brief stop logging
+
+  \return  FatFS error code (0=ok)
+
+  stop logging, write remaining data incl. partially filled buffer and
+  sync file. Afterwards close file via f_close()
+*/
+uint8_t sdlog_end(void) {
+
+  FRESULT   res;
+
+  // abort after previous error
+  if (m_sdlog_stats.err)
+    return(m_sdlog_stats.err);
+
+  // stop sampling. ISR doesn't access buffers anymore
+  g_sdlog_active = 0;
+
+  // write pending full buffer
+  if (m_sdlog_pending) {
+    if (sdlog_writeFile(m_sdlog_buf[m_sdlog_fill ^ 1], SDLOG_SECTOR))
+      return(m_sdlog_stats.err);
+    m_sdlog_pending = 0;
+  }
+
+  // write partial buffer
+  if (m_sdlog_idx) {
+    if (sdlog_writeFile(m_sdlog_buf[m_sdlog_fill], m_sdlog_idx))
+      return(m_sdlog_stats.err);
+    m_sdlog_idx = 0;
+  }
+
+  // final sync
+  m_sdlog_stats.numSync++;
+  res = f_sync(m_sdlog_fp);
+
+  return(sdlog_stop((uint8_t) res));
+
+} // sdlog_end
+
+
+
+/**
+  \fn void sdlog_getStats(sdlog_stats_t *pStats)
+
+  \brief get logger statistics
+
+  \param[out] pStats  copy of statistics
+
+  get consistent copy of statistics, which are partly updated in ISR.
+  Call only from main loop
+*/
+void sdlog_getStats(sdlog_stats_t *pStats) {
+
+  noInterrupts();
+  *pStats = m_sdlog_stats;
+  interrupts();
+
+} // sdlog_getStats
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
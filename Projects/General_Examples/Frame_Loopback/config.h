@@ -0,0 +1,44 @@
+/**
+  \file config.h
+   
+  \author G. Icking-Konert
+  \date 2026-10-17
+  \version 0.1
+   
+  \brief project specific settings
+   
+  project specific configuration header file
+  Select STM8 device and activate optional options
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _CONFIG_H_
+#define _CONFIG_H_
+
+
+// select board to set STM8 family, memory size etc. 
+//#include "muBoard_config.h"
+
+/// alternatively select STM8 device directly. For supported devices see file "stm8as.h"
+#define STM8S208      // muBoard
+
+
+/// required for timekeeping (1ms interrupt)
+#define USE_TIM4_UPD_ISR
+
+/// interrupt driven UART1 with ring buffers
+#define USE_UART1_RXF_ISR
+#define USE_UART1_TXE_ISR
+#define USE_UART1_BUFFER
+#define UART1_TX_BUFFER_SIZE  128
+
+/// max. frame payload [B]
+#define FRAME_BUFFER_SIZE     64
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif  // _CONFIG_H_
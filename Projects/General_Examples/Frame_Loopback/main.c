@@ -0,0 +1,116 @@
+/**********************
+  Arduino-like project with setup() & loop(). 
+  Echo SLIP frames with CRC16 received via UART1. Counterpart
+  for host test Tools/frame_loopback.py (throughput and resync)
+  Functionality:
+  - configure UART1 for interrupt driven, buffered communication
+  - feed received bytes from RXF ISR to frame state machine
+  - echo each valid frame to PC
+  - on empty frame reply with receive statistics
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include <string.h>
+#include "main_general.h"    // board-independent main
+#include "uart1.h"           // UART1 communication
+#include "frame.h"           // framed packet protocol
+
+
+/*----------------------------------------------------------
+    GLOBAL VARIABLES
+----------------------------------------------------------*/
+uint8_t             g_buf[FRAME_BUFFER_SIZE];   // copy of last received frame
+volatile uint8_t    g_len;                      // payload size of last received frame
+volatile uint8_t    g_flagFrame = 0;            // frame waiting to be echoed
+volatile uint16_t   g_numDropped = 0;           // frames received while previous frame still pending
+
+
+/*----------------------------------------------------------
+    FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn void receiveFrame(uint8_t num, uint8_t *buf)
+ 
+  \brief callback for received frame
+  
+  \param[in]  num   payload size [B]
+  \param[in]  buf   payload
+  
+  called from UART1 receive ISR for each valid frame. Copy 
+  frame for main loop, because buffer is re-used afterwards
+*/
+void receiveFrame(uint8_t num, uint8_t *buf) {
+
+  // previous frame not yet processed -> drop
+  if (g_flagFrame) {
+    g_numDropped++;
+    return;
+  }
+
+  // copy frame and notify main loop
+  memcpy(g_buf, buf, num);
+  g_len = num;
+  g_flagFrame = 1;
+   
+} // receiveFrame
+
+
+
+//////////
+// user setup, called once after reset
+//////////
+void setup() {
+
+  // init UART1 to 115.2kBaud, 8N1, full duplex
+  UART1_begin(115200);
+
+  // init frame protocol and feed with bytes from UART1 receive ISR
+  frame_begin(UART1_write, receiveFrame);
+  UART1_attachReceive(frame_receiveByte);
+  
+  // configure LED pin as output
+  pinMode(&PORT_H, 3, OUTPUT);    // muBoard LED
+
+} // setup
+
+
+
+//////////
+// user loop, called continuously
+//////////
+void loop() {
+  
+  uint8_t   stats[10];
+
+  // wait for frame from PC
+  if (!g_flagFrame)
+    return;
+  
+  // empty frame -> reply statistics (MSB first)
+  if (g_len == 0) {
+    stats[0] = (uint8_t) (frame_numOk() >> 8);        stats[1] = (uint8_t) frame_numOk();
+    stats[2] = (uint8_t) (frame_errCrc() >> 8);       stats[3] = (uint8_t) frame_errCrc();
+    stats[4] = (uint8_t) (frame_errOverflow() >> 8);  stats[5] = (uint8_t) frame_errOverflow();
+    stats[6] = (uint8_t) (frame_errEscape() >> 8);    stats[7] = (uint8_t) frame_errEscape();
+    stats[8] = (uint8_t) (g_numDropped >> 8);         stats[9] = (uint8_t) g_numDropped;
+    frame_send(10, stats);
+  }
+
+  // echo frame
+  else
+    frame_send(g_len, g_buf);
+  
+  // release buffer for next frame
+  g_flagFrame = 0;
+
+  // indicate activity
+  pinToggle(&PORT_H, 3);
+
+} // loop
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
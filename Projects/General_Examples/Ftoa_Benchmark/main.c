@@ -0,0 +1,158 @@
+/**********************
+  Arduino-like project with setup() & loop(). 
+  Measure speed of floatToString() with direct digit extraction
+  vs. previous implementation based on sprintf(). Runs on target
+  or in ucsim STM8 simulator (sstm8) with UART1 output. 
+  Functionality:
+  - configure UART1
+  - convert a set of floats N times with both implementations
+  - print duration per conversion, cycles and example results
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "main_general.h"    // board-independent main
+#include "uart1.h"           // UART1 communication
+#include "putchar.h"         // for printf()
+
+
+/*----------------------------------------------------------
+    MACROS
+----------------------------------------------------------*/
+
+// number of repetitions for measurement
+#define NUM_LOOPS     100
+
+// number of decimals
+#define DIGITS        3
+
+// CPU clock [MHz] for cycle calculation
+#define FCPU_MHZ      16
+
+
+/*----------------------------------------------------------
+    GLOBAL VARIABLES
+----------------------------------------------------------*/
+
+// test values
+const float g_value[] = {0.0, 1.0, -0.0004, 3.14159, -2.71828, 123.456, 9.9996, -65535.5, 1234567.8};
+#define NUM_VALUES  (sizeof(g_value)/sizeof(g_value[0]))
+
+
+/*----------------------------------------------------------
+    FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn char *floatToString_sprintf(char *buf, float f, uint8_t digits)
+   
+  \brief previous floatToString() for comparison
+  
+  \param[out] buf     string to convert into
+  \param[in]  f       floating number to convert
+  \param[in]  digits  number of digits
+  
+  \return buf
+
+  previous implementation of floatToString() via sprintf()
+*/
+char *floatToString_sprintf(char *buf, float f, uint8_t digits) {
+  
+  uint8_t   i;
+  int32_t   scale;
+  int32_t   pre, post;
+  char      fmt[15];
+  
+  // clip digits to 6
+  if (digits > 6)
+    digits = 6;
+
+  // convert digits to scale for base 10
+  scale = 1;
+  for (i=0; i<digits; i++)
+    scale *= 10;
+ 
+  // separate integer and fractional numbers
+  pre  = (long) f;
+  post = (long) ((f - (float) pre) * (float) scale);
+  
+  // required for -0.x and trailing 0
+  if (f < 0.0)
+    sprintf(fmt, "-%%d.%%0%dd", (int) digits);
+  else
+    sprintf(fmt,  "%%d.%%0%dd", (int) digits);
+
+  // convert ints to string
+  sprintf(buf, fmt, abs((int) pre), abs((int) post));
+    
+  // return buf
+  return(buf);
+
+} // floatToString_sprintf
+
+
+
+/**
+  \fn void measure(const char *name, char *(*pFct)(char*, float, uint8_t))
+ 
+  \brief measure and print speed of float conversion
+  
+  \param[in]  name  name of tested function
+  \param[in]  pFct  conversion function
+*/
+void measure(const char *name, char *(*pFct)(char*, float, uint8_t)) {
+
+  char      buf[20];
+  uint8_t   i, j;
+  uint32_t  t;
+
+  // convert all values NUM_LOOPS times
+  t = millis();
+  for (i=0; i<NUM_LOOPS; i++) {
+    for (j=0; j<NUM_VALUES; j++)
+      pFct(buf, g_value[j], DIGITS);
+  }
+  t = millis() - t;
+
+  // print duration per conversion
+  printf("%s: %lu us/call, %lu cycles/call\n", name, t*1000L/(NUM_LOOPS*NUM_VALUES), t*1000L*FCPU_MHZ/(NUM_LOOPS*NUM_VALUES));
+
+  // print results
+  for (j=0; j<NUM_VALUES; j++)
+    printf("  %s\n", pFct(buf, g_value[j], DIGITS));
+
+} // measure
+
+
+
+//////////
+// user setup, called once after reset
+//////////
+void setup() {
+
+  // init UART1 to 115.2kBaud, 8N1, full duplex
+  UART1_begin(115200);
+  putcharAttach(UART1_write);
+  printf("\nbenchmark floatToString() (%d loops x %d values)\n", (int) NUM_LOOPS, (int) NUM_VALUES);
+
+  // measure both implementations
+  measure("floatToString()        ", floatToString);
+  measure("floatToString_sprintf()", floatToString_sprintf);
+
+} // setup
+
+
+
+//////////
+// user loop, called continuously
+//////////
+void loop() {
+  
+  // dummy, benchmark is done in setup()
+  
+} // loop
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
@@ -1,11 +1,13 @@
 /**********************
   Arduino-like project with setup() & loop(). Read number
   as string via UART from PC terminal and echo value back.
+  Line input is non-blocking, i.e. LED keeps blinking meanwhile
   Functionality:
   - configure UART1 for PC in-/output
   - use UART1 send for putchar() output
-  - use UART1 receive for gets() input
-  - read string from PC, convert to number and send value to PC
+  - collect line from UART1 via non-blocking gets_feed() with echo
+  - on complete line convert to number and send value to PC
+  - toggle LED every 500ms
 **********************/
 
 /*----------------------------------------------------------
@@ -14,7 +16,14 @@
 #include "main_general.h"    // board-independent main
 #include "uart1.h"           // UART1 communication
 #include "putchar.h"         // for printf()
-#include "getchar.h"         // for gets()
+#include "getchar.h"         // for gets_feed()
+#include "timeout.h"         // user timeout clocks
+
+
+/*----------------------------------------------------------
+    GLOBAL VARIABLES
+----------------------------------------------------------*/
+char    g_str[20];           // line buffer
 
 
 /*----------------------------------------------------------
@@ -32,11 +41,16 @@ void setup() {
   // use UART1 for printf() output
   putcharAttach(UART1_write);
 
-  // use UART1 blocking read for gets() input
-  getcharAttach(UART1_read);
+  // collect line in g_str with echo via UART1
+  gets_begin(g_str, sizeof(g_str), UART1_write);
   
+  // configure LED pin as output
+  pinMode(&PORT_H, 3, OUTPUT);    // muBoard LED
+  setTimeout(0, 500);
+
   // wait a it for console to launch
   sw_delay(1000);
+  printf("Enter a number: ");
 
 } // setup
 
@@ -47,18 +61,30 @@ void setup() {
 //////////
 void loop() {
   
-  char    str[20];
   int     num;
 
-  // read a string via UART1
-  printf("Enter a number: ");
-  gets(str);
-  
-  // convert to integer [-2^16; 2^16-1]
-  num = atoi(str);
+  // pass received chars to line assembler. Never blocks
+  while (UART1_available())
+    gets_feed(UART1_read());
+
+  // line complete
+  if (gets_ready()) {
+
+    // convert to integer [-2^16; 2^16-1]
+    num = atoi(g_str);
+    gets_release();
   
-  // print result via UART1
-  printf("value: %d\n\n", num);
+    // print result via UART1
+    printf("value: %d\n\n", num);
+    printf("Enter a number: ");
+
+  }
+
+  // meanwhile do real-time work, here blink LED
+  if (checkTimeout(0)) {
+    setTimeout(0, 500);
+    pinToggle(&PORT_H, 3);
+  }
   
 } // loop
 
@@ -0,0 +1,112 @@
+/**********************
+  Arduino-like project with setup() & loop().
+  Periodically ramp potentiometer resistance attached to I2C (muBoard)
+  via interrupt driven I2C transactions. CPU keeps counting meanwhile.
+  Used 20kR potentiometer: Analog Devices AD5280BRUZ20 (Farnell 1438441).
+  Connected via I2C pins PE1/SCL and PE2/SDA
+  Functionality:
+  - initialize I2C bus
+  - periodically queue 2 transactions: set resistance, read back resistance
+  - count loop iterations while I2C transfer is running in background
+  - print result via UART1
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "main_general.h"    // board-independent main
+#include "i2c.h"             // I2C communication
+#include "uart1.h"           // UART1 communication
+#include "putchar.h"         // for printf()
+
+// I2C address of potentiometer (see datasheet how to set)
+#define ADDR_POTI  46
+
+
+/*----------------------------------------------------------
+    GLOBAL VARIABLES
+----------------------------------------------------------*/
+
+uint8_t           bufWrite[2];          // I2C buffer for setting resistance
+uint8_t           bufRead[1];           // I2C buffer for reading resistance
+i2c_trans_t       transWrite;           // I2C transaction: set resistance
+i2c_trans_t       transRead;            // I2C transaction: read back resistance
+volatile uint8_t  flagDone;             // read back finished (set in callback)
+
+
+/*----------------------------------------------------------
+    FUNCTIONS
+----------------------------------------------------------*/
+
+//////////
+// called from I2C ISR after read back is finished
+//////////
+void readDone(i2c_trans_t *pTrans) {
+
+  flagDone = 1;
+
+} // readDone
+
+
+
+//////////
+// user setup, called once after reset
+//////////
+void setup() {
+
+  // init I2C bus
+  i2c_init();
+
+  // prepare I2C transactions
+  transWrite.addr      = ADDR_POTI;
+  transWrite.numTx     = 2;
+  transWrite.bufTx     = bufWrite;
+  transRead.addr       = ADDR_POTI;
+  transRead.numRx      = 1;
+  transRead.bufRx      = bufRead;
+  transRead.pCallback  = readDone;
+
+  // init UART1 to 115.2kBaud, 8N1, full duplex
+  UART1_begin(115200);
+
+  // use UART1 for printf() output
+  putcharAttach(UART1_write);
+
+} // setup
+
+
+
+//////////
+// user loop, called continuously
+//////////
+void loop() {
+
+  static uint8_t  res = 0;          // resistance in [Rmax/255]
+  uint16_t        count = 0;        // loop iterations during I2C transfer
+
+  // queue I2C transactions and return immediately
+  bufWrite[0] = 0x00;
+  bufWrite[1] = res;
+  flagDone = 0;
+  i2c_submit(&transWrite);
+  i2c_submit(&transRead);
+
+  // do something useful until I2C is finished. Watchdog aborts hanging transactions
+  while (!flagDone) {
+    count++;
+    i2c_checkQueue();
+  }
+
+  // print to terminal
+  printf("set %d, read %d, err=%d/%d, count=%u\n", (int) res, (int) bufRead[0],
+    (int) transWrite.status, (int) transRead.status, count);
+  res += 8;
+
+  // wait a bit
+  sw_delay(500);
+
+} // loop
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
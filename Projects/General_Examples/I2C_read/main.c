@@ -52,10 +52,8 @@ void loop() {
   uint8_t   buf[10];    // I2C buffer
   uint8_t   err;        // I2C err state
   
-  // read data from I2C slave
-  err  = i2c_start();                   // generate start condition
-  err |= i2c_request(ADDR_I2C,6,buf);   // send data
-  err |= i2c_stop();                    // generate stop condition
+  // read data from I2C slave incl. start/stop condition and NACK of last byte
+  err = i2c_writeRead(ADDR_I2C, 0, NULL, 6, buf);
 
   // terminate C-string for output
   buf[6] = '\0';
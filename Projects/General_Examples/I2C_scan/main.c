@@ -0,0 +1,75 @@
+/**********************
+  Arduino-like project with setup() & loop().
+  Periodically scan I2C bus for slaves and print found addresses.
+  Connected via I2C pins PE1/SCL and PE2/SDA
+  Functionality:
+  - initialize I2C bus
+  - periodically probe all 7-bit addresses (see i2c_scan())
+  - print addresses of found slaves and I2C error statistics via UART1
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "main_general.h"    // board-independent main
+#include "i2c.h"             // I2C communication
+#include "uart1.h"           // UART1 communication
+#include "putchar.h"         // for printf()
+
+
+/*----------------------------------------------------------
+    FUNCTIONS
+----------------------------------------------------------*/
+
+//////////
+// user setup, called once after reset
+//////////
+void setup() {
+
+  // init I2C bus
+  i2c_init();
+
+  // init UART1 to 115.2kBaud, 8N1, full duplex
+  UART1_begin(115200);
+
+  // use UART1 for printf() output
+  putcharAttach(UART1_write);
+
+} // setup
+
+
+
+//////////
+// user loop, called continuously
+//////////
+void loop() {
+
+  uint8_t   addr, num;
+  uint32_t  t;
+
+  // scan bus. Result is stored in presence cache
+  t = millis();
+  num = i2c_scan();
+  t = millis() - t;
+
+  // print addresses of found slaves
+  printf("%ld  %d slave(s) found in %ldms:", millis(), (int) num, t);
+  for (addr=0; addr<128; addr++) {
+    if (i2c_isPresent(addr))
+      printf(" 0x%02x", (int) addr);
+  }
+  printf("\n");
+
+  // print bus health
+  printf("  errors: timeout=%u, NACK data=%u, ARLO=%u, bus=%u, stuck=%u, recoveries=%u\n",
+    i2c_errCount(I2C_ERR_TIMEOUT), i2c_errCount(I2C_ERR_NACK_DATA), i2c_errCount(I2C_ERR_ARLO),
+    i2c_errCount(I2C_ERR_BUS), i2c_errCount(I2C_ERR_STUCK), i2c_numRecover());
+
+  // wait a bit
+  sw_delay(2000);
+
+} // loop
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
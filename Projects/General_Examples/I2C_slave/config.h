@@ -0,0 +1,51 @@
+/**
+  \file config.h
+   
+  \author G. Icking-Konert
+  \date 2026-10-17
+  \version 0.1
+   
+  \brief project specific settings
+   
+  project specific configuration header file
+  Select STM8 device and project options as required
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _CONFIG_H_
+#define _CONFIG_H_
+
+
+/*-----------------------------------------------------------------------------
+    GENERAL PROJECT SETTINGS
+-----------------------------------------------------------------------------*/
+ 
+/// select STM8 device (no default). For supported devices see file "stm8as.h"
+#define STM8S208      // muBoard
+
+
+/*-----------------------------------------------------------------------------
+    ISR SETTINGS
+-----------------------------------------------------------------------------*/
+
+/// required for timekeeping (1ms interrupt)
+#define USE_TIM4_UPD_ISR
+
+/// I2C interrupt, used by slave
+#define USE_I2C_ISR
+
+
+/*-----------------------------------------------------------------------------
+    I2C SETTINGS
+-----------------------------------------------------------------------------*/
+
+/// interrupt driven I2C slave (see i2c_slave.h)
+#define USE_I2C_SLAVE
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif  // _CONFIG_H_
@@ -0,0 +1,116 @@
+/**********************
+  Arduino-like project with setup() & loop().
+  STM8 acts as I2C slave with a register map, like a sensor.
+  Master e.g. Arduino with Wire library. Connected via I2C pins PE1/SCL and PE2/SDA
+  Register map:
+    - 0..3: millis() at start of master read (MSB first, read-only)
+    - 4..7: scratch registers (read/write)
+  Functionality:
+  - configure I2C as slave with address 0x10
+  - update time registers on master read
+  - print registers written by master via UART1
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "main_general.h"    // board-independent main
+#include "i2c_slave.h"       // I2C slave
+#include "uart1.h"           // UART1 communication
+#include "putchar.h"         // for printf()
+
+// own I2C address
+#define ADDR_I2C  0x10
+
+
+/*----------------------------------------------------------
+    GLOBAL VARIABLES
+----------------------------------------------------------*/
+
+uint8_t           regs[8];              // I2C register map
+volatile uint8_t  regWrite;             // first register written by master
+volatile uint8_t  numWrite;             // number of registers written by master (0=none)
+
+
+/*----------------------------------------------------------
+    FUNCTIONS
+----------------------------------------------------------*/
+
+//////////
+// called from I2C ISR before master reads registers
+//////////
+void readRegs(uint8_t reg) {
+
+  uint32_t  t = millis();
+
+  // update time registers (big endian)
+  regs[0] = (uint8_t) (t >> 24);
+  regs[1] = (uint8_t) (t >> 16);
+  regs[2] = (uint8_t) (t >> 8);
+  regs[3] = (uint8_t) t;
+
+} // readRegs
+
+
+
+//////////
+// called from I2C ISR after master wrote registers
+//////////
+void writeRegs(uint8_t reg, uint8_t num) {
+
+  // store for output in loop(). Writes to time registers are overwritten on next read
+  regWrite = reg;
+  numWrite = num;
+
+} // writeRegs
+
+
+
+//////////
+// user setup, called once after reset
+//////////
+void setup() {
+
+  // init UART1 to 115.2kBaud, 8N1, full duplex
+  UART1_begin(115200);
+
+  // use UART1 for printf() output
+  putcharAttach(UART1_write);
+
+  // start I2C slave with register map
+  i2c_slave_begin(ADDR_I2C, sizeof(regs), regs, writeRegs, readRegs);
+
+} // setup
+
+
+
+//////////
+// user loop, called continuously
+//////////
+void loop() {
+
+  uint8_t   i, reg, num;
+
+  // master wrote registers -> print them
+  if (numWrite) {
+
+    // consistent copy of new data
+    i2c_slave_lock();
+    reg = regWrite;
+    num = numWrite;
+    numWrite = 0;
+    i2c_slave_unlock();
+
+    // print to terminal
+    printf("%ld  write reg %d:", millis(), (int) reg);
+    for (i=reg; (i<reg+num) && (i<sizeof(regs)); i++)
+      printf(" 0x%02x", (int) regs[i]);
+    printf("\n");
+
+  } // if numWrite
+
+} // loop
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,148 @@
+/**********************
+  Arduino-like project with setup() & loop(). 
+  Measure speed of lightweight print() vs. stdio printf().
+  Output is counted by a dummy putchar() sink, i.e. UART 
+  speed is not included. Result is sent via UART1.
+  Only one formatter is linked (BENCH_PRINT or BENCH_PRINTF in config.h),
+  i.e. also the results and report use it. For code size build both
+  variants and compare CODE size in output/main.map (no hardware required).
+  Budget for print(): <=1.5kB flash (<20% of 8kB STM8S103) and
+  <=150 cycles/char, see PRINT_BUDGET_xxx
+  Functionality:
+  - configure UART1
+  - format typical log lines N times into dummy sink
+  - print duration per call and cycles per character vs. budget
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "main_general.h"    // board-independent main
+#include "uart1.h"           // UART1 communication
+#include "putchar.h"         // for printf()
+#if defined(BENCH_PRINT)
+  #include "print.h"         // lightweight print()
+#endif
+
+
+/*----------------------------------------------------------
+    MACROS
+----------------------------------------------------------*/
+
+// number of repetitions for measurement
+#define NUM_LOOPS     500
+
+// CPU clock [MHz] for cycle calculation
+#define FCPU_MHZ      16
+
+// budget of print(). Code size is checked via output/main.map
+#define PRINT_BUDGET_FLASH    1536    // max. code size [B] of print.c
+#define PRINT_BUDGET_CYCLES   150     // max. cycles per character
+
+// formatter under test. Exactly one is linked
+#if defined(BENCH_PRINT) && !defined(BENCH_PRINTF)
+  #define BENCH_OUT   print
+  #define BENCH_NAME  "print()"
+#elif defined(BENCH_PRINTF) && !defined(BENCH_PRINT)
+  #define BENCH_OUT   printf
+  #define BENCH_NAME  "printf()"
+#else
+  #error select exactly one of BENCH_PRINT or BENCH_PRINTF in config.h
+#endif
+
+
+/*----------------------------------------------------------
+    GLOBAL VARIABLES
+----------------------------------------------------------*/
+uint32_t    g_numChars;     // number of characters sent to dummy sink
+
+
+/*----------------------------------------------------------
+    FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn void countChar(uint8_t c)
+ 
+  \brief dummy putchar() sink
+  
+  \param[in]  c   character (ignored)
+
+  dummy output for measurement. Only count characters
+*/
+void countChar(uint8_t c) {
+
+  (void) c;
+  g_numChars++;
+
+} // countChar
+
+
+
+/**
+  \fn void report(uint32_t ms)
+ 
+  \brief print measurement result via UART1
+  
+  \param[in]  ms    duration for NUM_LOOPS calls [ms]
+
+  print result with formatter under test, i.e. no other formatter is linked
+*/
+void report(uint32_t ms) {
+
+  uint32_t  numChars = g_numChars;
+  uint32_t  cycles = ms*1000L*FCPU_MHZ/numChars;
+
+  putcharAttach(UART1_write);
+  BENCH_OUT("%s: %lu chars in %lu ms -> %lu us/call, %lu cycles/char\n", BENCH_NAME, numChars, ms,
+    ms*1000L/NUM_LOOPS, cycles);
+  BENCH_OUT("budget print(): %u cycles/char -> %s, %uB flash -> check output/main.map\n",
+    (unsigned int) PRINT_BUDGET_CYCLES, (cycles <= PRINT_BUDGET_CYCLES) ? "ok" : "exceeded",
+    (unsigned int) PRINT_BUDGET_FLASH);
+
+} // report
+
+
+
+//////////
+// user setup, called once after reset
+//////////
+void setup() {
+
+  uint16_t  i;
+  uint32_t  t;
+
+  // init UART1 to 115.2kBaud, 8N1, full duplex
+  UART1_begin(115200);
+  putcharAttach(UART1_write);
+  BENCH_OUT("\nbenchmark %s (%d loops)\n", BENCH_NAME, (int) NUM_LOOPS);
+
+  // format typical log line into dummy sink. Same output for both formatters
+  putcharAttach(countChar);
+  g_numChars = 0;
+  t = millis();
+  for (i=0; i<NUM_LOOPS; i++) {
+    #if defined(BENCH_PRINT)
+      print("t=%lu ch%d=%5d x=%04x v=%.3q\n", millis(), (int) (i & 7), (int) i-250, i, (int) i*7);
+    #else
+      printf("t=%lu ch%d=%5d x=%04x v=%d.%03d\n", millis(), (int) (i & 7), (int) i-250, i, (int) i*7/1000, (int) i*7%1000);
+    #endif
+  }
+  report(millis()-t);
+
+} // setup
+
+
+
+//////////
+// user loop, called continuously
+//////////
+void loop() {
+  
+  // dummy, benchmark is done in setup()
+  
+} // loop
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
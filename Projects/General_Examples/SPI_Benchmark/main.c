@@ -0,0 +1,202 @@
+/**********************
+  Arduino-like project with setup() & loop().
+  Measure SPI throughput at f_CPU/2 of pipelined spi_write(), spi_read()
+  and spi_transfer() vs. a simple byte-by-byte loop.
+  For data check connect MOSI (PC6) and MISO (PC7). Result is sent via UART1.
+  Functionality:
+  - initialize SPI as 4-wire master with BR=f_CPU/2
+  - transfer a block N times with each variant
+  - repeat spi_transfer() with interrupts disabled, i.e. w/o overruns
+  - repeat spi_transfer() with a long 1ms interrupt to check overrun handling
+  - print throughput, overruns and data errors
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "main_general.h"    // board-independent main
+#include "spi.h"             // SPI communication
+#include "uart1.h"           // UART1 communication
+#include "putchar.h"         // for printf()
+#include "print.h"           // lightweight print()
+
+
+/*----------------------------------------------------------
+    MACROS
+----------------------------------------------------------*/
+
+// size of data block [B]
+#define NUM_DATA      512
+
+// number of repetitions for measurement
+#define NUM_LOOPS     100
+
+
+/*----------------------------------------------------------
+    GLOBAL VARIABLES
+----------------------------------------------------------*/
+uint8_t     bufTx[NUM_DATA];      // SPI send buffer
+uint8_t     bufRx[NUM_DATA];      // SPI receive buffer
+
+
+/*----------------------------------------------------------
+    FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn void longISR(void)
+ 
+  \brief long user function in 1ms interrupt
+  
+  block CPU for several SPI frames, i.e. provoke overrun in spi_transfer()
+*/
+void longISR(void) {
+
+  sw_delayMicroseconds(20);
+
+} // longISR
+
+
+
+/**
+  \fn void simpleTransfer(uint16_t num, uint8_t *tx, uint8_t *rx)
+ 
+  \brief reference: byte-by-byte SPI transfer
+  
+  \param[in]  num   number of bytes
+  \param[in]  tx    send buffer
+  \param[out] rx    receive buffer
+
+  send one byte and wait until it is received, i.e. SCK pauses between bytes
+*/
+void simpleTransfer(uint16_t num, uint8_t *tx, uint8_t *rx) {
+
+  while (num--) {
+    SPI.DR.byte = *(tx++);
+    while (!SPI.SR.reg.RXNE);
+    *(rx++) = SPI.DR.byte;
+  }
+
+} // simpleTransfer
+
+
+
+/**
+  \fn void report(const char *name, uint32_t ms, uint16_t numOvr, uint8_t flagCheck)
+ 
+  \brief print measurement result via UART1
+  
+  \param[in]  name        name of tested function
+  \param[in]  ms          duration for NUM_LOOPS transfers [ms]
+  \param[in]  numOvr      number of transfers with overrun
+  \param[in]  flagCheck   check loopback data. Only valid w/o overrun in last transfer
+*/
+void report(const char *name, uint32_t ms, uint16_t numOvr, uint8_t flagCheck) {
+
+  uint16_t  i, numErr = 0;
+
+  // check loopback data
+  if (flagCheck) {
+    for (i=0; i<NUM_DATA; i++) {
+      if (bufRx[i] != bufTx[i])
+        numErr++;
+    }
+  }
+
+  // avoid division by zero
+  if (ms == 0)
+    ms = 1;
+
+  print("%s: %lu kB/s, overruns=%u, errors=%u\n", name, (uint32_t) NUM_DATA * NUM_LOOPS / ms, numOvr, numErr);
+
+} // report
+
+
+
+//////////
+// user setup, called once after reset
+//////////
+void setup() {
+
+  uint16_t  i;
+
+  // init SPI as 4-wire master, BR=f_CPU/2, MSB first, mode 0
+  spi_init_master(SPI_4_WIRE, 0, MSBFIRST, SPI_MODE0);
+
+  // init send buffer
+  for (i=0; i<NUM_DATA; i++)
+    bufTx[i] = (uint8_t) (i ^ (i >> 8));
+
+  // init UART1 to 115.2kBaud, 8N1, full duplex
+  UART1_begin(115200);
+
+  // use UART1 for printf() output
+  putcharAttach(UART1_write);
+
+} // setup
+
+
+
+//////////
+// user loop, called continuously
+//////////
+void loop() {
+
+  uint16_t  i, numOvr;
+  uint32_t  t;
+
+  print("\nSPI throughput at f_CPU/2, %u x %u B:\n", (uint16_t) NUM_LOOPS, (uint16_t) NUM_DATA);
+
+  // reference
+  t = millis();
+  for (i=0; i<NUM_LOOPS; i++)
+    simpleTransfer(NUM_DATA, bufTx, bufRx);
+  report("byte-by-byte", millis() - t, 0, 1);
+
+  // send only
+  t = millis();
+  for (i=0; i<NUM_LOOPS; i++)
+    spi_write(NUM_DATA, bufTx);
+  report("spi_write   ", millis() - t, 0, 0);
+
+  // receive only
+  numOvr = 0;
+  t = millis();
+  for (i=0; i<NUM_LOOPS; i++)
+    numOvr += spi_read(NUM_DATA, bufRx);
+  report("spi_read    ", millis() - t, numOvr, 0);
+
+  // exchange
+  numOvr = 0;
+  t = millis();
+  for (i=0; i<NUM_LOOPS; i++)
+    numOvr += spi_transfer(NUM_DATA, bufTx, bufRx);
+  report("spi_transfer", millis() - t, numOvr, 1);
+
+  // exchange with interrupts disabled -> no overrun
+  numOvr = 0;
+  t = millis();
+  for (i=0; i<NUM_LOOPS; i++) {
+    noInterrupts();
+    numOvr += spi_transfer(NUM_DATA, bufTx, bufRx);
+    interrupts();
+  }
+  report("w/o ISR     ", millis() - t, numOvr, 1);
+
+  // exchange with long 1ms interrupt -> overruns are detected and aborted, no lockup
+  attachInterruptMillis(longISR);
+  numOvr = 0;
+  t = millis();
+  for (i=0; i<NUM_LOOPS; i++)
+    numOvr += spi_transfer(NUM_DATA, bufTx, bufRx);
+  detachInterruptMillis();
+  report("long ISR    ", millis() - t, numOvr, 0);
+
+  // wait a bit
+  sw_delay(2000);
+
+} // loop
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
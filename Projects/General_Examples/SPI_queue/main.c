@@ -0,0 +1,125 @@
+/**********************
+  Arduino-like project with setup() & loop().
+  Periodically send data via interrupt driven SPI transfers, while
+  CPU keeps counting. For test connect MOSI (PC6) and MISO (PC7).
+  Functionality:
+  - initialize SPI as 4-wire master, CSN on pin PE5
+  - periodically queue 2 transfers: command (CSN kept low) + data block
+  - count loop iterations while SPI transfer is running in background
+  - check received data and print result via UART1
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "main_general.h"    // board-independent main
+#include "spi.h"             // SPI communication
+#include "gpio.h"            // pin access
+#include "uart1.h"           // UART1 communication
+#include "putchar.h"         // for printf()
+
+// size of data block [B]
+#define NUM_DATA   512
+
+
+/*----------------------------------------------------------
+    GLOBAL VARIABLES
+----------------------------------------------------------*/
+
+uint8_t           bufCmd[2];            // SPI command
+uint8_t           bufTx[NUM_DATA];      // SPI send buffer
+uint8_t           bufRx[NUM_DATA];      // SPI receive buffer
+spi_trans_t       transCmd;             // SPI transfer: command
+spi_trans_t       transData;            // SPI transfer: data
+volatile uint8_t  flagDone;             // data transfer finished (set in callback)
+
+
+/*----------------------------------------------------------
+    FUNCTIONS
+----------------------------------------------------------*/
+
+//////////
+// called from SPI ISR after data transfer is finished
+//////////
+void dataDone(spi_trans_t *pTrans) {
+
+  flagDone = 1;
+
+} // dataDone
+
+
+
+//////////
+// user setup, called once after reset
+//////////
+void setup() {
+
+  uint16_t  i;
+
+  // configure CSN pin (high = not selected)
+  pinHigh(&PORT_E, 5);
+  pinMode(&PORT_E, 5, OUTPUT);
+
+  // init SPI as 4-wire master, BR=f_CPU/16, MSB first, mode 0
+  spi_init_master(SPI_4_WIRE, 3, MSBFIRST, SPI_MODE0);
+
+  // prepare SPI transfers. Command keeps CSN low for following data
+  bufCmd[0] = 0x02;
+  bufCmd[1] = 0x00;
+  transCmd.pPortCSN   = &PORT_E;
+  transCmd.pinCSN     = 5;
+  transCmd.flags      = SPI_KEEP_CS;
+  transCmd.num        = sizeof(bufCmd);
+  transCmd.bufTx      = bufCmd;
+  transData.pPortCSN  = &PORT_E;
+  transData.pinCSN    = 5;
+  transData.num       = NUM_DATA;
+  transData.bufTx     = bufTx;
+  transData.bufRx     = bufRx;
+  transData.pCallback = dataDone;
+  for (i=0; i<NUM_DATA; i++)
+    bufTx[i] = (uint8_t) i;
+
+  // init UART1 to 115.2kBaud, 8N1, full duplex
+  UART1_begin(115200);
+
+  // use UART1 for printf() output
+  putcharAttach(UART1_write);
+
+} // setup
+
+
+
+//////////
+// user loop, called continuously
+//////////
+void loop() {
+
+  uint16_t  i, count = 0, numErr = 0;
+
+  // queue SPI transfers and return immediately
+  flagDone = 0;
+  spi_submit(&transCmd);
+  spi_submit(&transData);
+
+  // do something useful until SPI is finished
+  while (!flagDone)
+    count++;
+
+  // check loopback data
+  for (i=0; i<NUM_DATA; i++) {
+    if (bufRx[i] != bufTx[i])
+      numErr++;
+  }
+
+  // print to terminal
+  printf("%ld  status=%d, errors=%u, count=%u\n", millis(), (int) transData.status, numErr, count);
+
+  // wait a bit
+  sw_delay(1000);
+
+} // loop
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
@@ -19,8 +19,8 @@
 //////////
 void setup() {
 
-  // init I2C module 
-  i2c_init();
+  // init I2C module in fast mode (400kHz)
+  i2c_begin(I2C_SPEED_FAST);
   
   // init and reset LCD display
   BTHQ21605V_lcd_init(&PORT_E, 3);
@@ -39,6 +39,25 @@
 #define _USE_LSEEK  1    // Enable pf_lseek() function (+ 613B flash)
 
 
+///////////
+// optionally use hardware SPI (SCK=PC5, MOSI=PC6, MISO=PC7) instead of bitbanging.
+// Then only INIT_PORT() and SPI_SD_CSN are used
+///////////
+//#define USE_SD_HW_SPI
+
+
+///////////
+// optionally enable f_expand() and sector streaming via f_stream_open() etc.
+///////////
+//#define FF_USE_EXPAND  1
+
+
+///////////
+// optionally cache N sectors (LRU, write-back) for FAT and directory accesses. Requires N*512B RAM
+///////////
+//#define SD_CACHE_SECTORS  2
+
+
 ///////////
 // define macros required in PetitFS diskio.c and bitbang mode
 ///////////
@@ -0,0 +1,137 @@
+/**********************
+  Arduino-like project with setup() & loop(). 
+  continuously log samples to SD card via FatFS and double-buffered
+  sectors. Samples are taken in the 1ms interrupt, full sectors are
+  written in the main loop. After 10s print statistics.
+  Notes:
+    - SD cards generally use 3.3V -> check schematics
+    - pin macros are required in 'config.h'
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "main_general.h"    // board-independent main
+#include "uart1.h"           // UART1 communication
+#include "putchar.h"         // for printf()
+#include "ff.h"              // SD card with FatFS file system
+#include "sdLogger.h"        // double-buffered data logger
+
+
+/*----------------------------------------------------------
+    MACROS
+----------------------------------------------------------*/
+
+// logging duration [ms]
+#define LOG_DURATION    10000L
+
+// f_sync() every N sectors
+#define LOG_SYNC        16
+
+
+/*----------------------------------------------------------
+    GLOBALS
+----------------------------------------------------------*/
+
+FATFS    FatFs;  /* FatFs work area needed for each volume */
+FIL      Fil;    /* File object needed for each open file */
+
+
+/*----------------------------------------------------------
+    FUNCTIONS
+----------------------------------------------------------*/
+
+//////////
+// take sample, called every 1ms from TIM4 ISR
+//////////
+void sample(void) {
+
+  static uint16_t  count = 0;
+  uint8_t          buf[6];
+  uint32_t         time = millis();
+
+  // sample: time [ms] and counter
+  buf[0] = (uint8_t) (time >> 24);
+  buf[1] = (uint8_t) (time >> 16);
+  buf[2] = (uint8_t) (time >> 8);
+  buf[3] = (uint8_t) time;
+  buf[4] = (uint8_t) (count >> 8);
+  buf[5] = (uint8_t) count;
+  count++;
+
+  // append to log buffer. Dropped samples are counted
+  sdlog_write(buf, 6);
+
+} // sample
+
+
+
+//////////
+// user setup, called once after reset
+//////////
+void setup() {
+
+  FRESULT  err;
+
+  // init UART1 to 115.2kBaud, 8N1, full duplex
+  UART1_begin(115200);
+
+  // use UART1 for printf() output
+  putcharAttach(UART1_write);
+
+  // wait for terminal to launch
+  delay(1000);
+  
+  // mount SD card
+  printf("mount SD card\n");
+  err = f_mount(&FatFs, "", 0);
+  if (err) f_print_error(err,1);
+
+  // create new file
+  printf("create file 'log.bin'\n");
+  err = f_open(&Fil, "log.bin", FA_WRITE | FA_CREATE_ALWAYS);
+  if (err) f_print_error(err,1);
+
+  // start logger and sampling in 1ms ISR
+  printf("start logging ... ");
+  sdlog_begin(&Fil, LOG_SYNC);
+  attachInterruptMillis(sample);
+
+} // setup
+
+
+
+//////////
+// user loop, called continuously
+//////////
+void loop() {
+  
+  sdlog_stats_t  stats;
+  uint8_t        err;
+
+  // write full sectors to SD card
+  err = sdlog_task();
+  if (err) f_print_error(err,1);
+
+  // continue logging
+  if (millis() < LOG_DURATION)
+    return;
+
+  // stop sampling and logger, then close file
+  detachInterruptMillis();
+  err = sdlog_end();
+  if (err) f_print_error(err,1);
+  f_close(&Fil);
+  printf("done\n");
+
+  // print statistics
+  sdlog_getStats(&stats);
+  printf("samples:  %ld\n", (long) stats.numSamples);
+  printf("dropped:  %ld\n", (long) stats.numDropped);
+  printf("sectors:  %ld\n", (long) stats.numSectors);
+  printf("syncs:    %d\n",  (int) stats.numSync);
+
+  printf("\nTest completed.\n");
+  for (;;) ;
+
+} // loop
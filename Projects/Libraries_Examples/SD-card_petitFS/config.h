@@ -39,6 +39,13 @@
 #define _USE_LSEEK  1    // Enable pf_lseek() function (+ 613B flash)
 
 
+///////////
+// optionally use hardware SPI (SCK=PC5, MOSI=PC6, MISO=PC7) instead of bitbanging.
+// Then only INIT_PORT() and SPI_SD_CSN are used
+///////////
+//#define USE_SD_HW_SPI
+
+
 ///////////
 // define macros required in PetitFS diskio.c and bitbang mode
 ///////////
@@ -91,6 +91,15 @@ void loop() {
 			  putchar(buff[i]);
 	  }
 	  if (rc) pf_print_error(rc,1);
+
+	  // stream content directly to UART w/o buffer (pf_read() with NULL)
+	  printf("\n\nStream the file content.\n");
+	  rc = pf_open("MESSAGE.TXT");
+	  if (rc) pf_print_error(rc,1);
+	  pf_attachForward(UART1_write);
+	  rc = pf_read(NULL, 0xFFFF, &br);		/* Read up to 64kB, is truncated to file size */
+	  pf_attachForward(NULL);
+	  if (rc) pf_print_error(rc,1);
   
   #endif // _USE_READ
 
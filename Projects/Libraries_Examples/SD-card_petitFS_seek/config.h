@@ -0,0 +1,69 @@
+/**
+  \file config.h
+   
+  \author G. Icking-Konert
+  \date 2026-10-17
+  \version 0.1
+   
+  \brief project specific settings
+   
+  project specific configuration header file
+  Select STM8 device and activate optional options
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _CONFIG_H_
+#define _CONFIG_H_
+
+
+// select board to set STM8 family, memory size etc. 
+//#include "muBoard_config.h"
+
+/// alternatively select STM8 device directly. For supported devices see file "stm8as.h"
+#define STM8S208      // muBoard
+
+
+/// required for timekeeping (1ms interrupt)
+#define USE_TIM4_UPD_ISR
+
+
+
+///////////
+// configure PetitFS, see http://elm-chan.org/fsw/ff/00index_p.html
+// Comment out profile for reference FAT16 build w/o cluster link cache
+///////////
+#define _PFF_PROFILE_SEEK32     // FAT16+FAT32, pf_read(), pf_lseek() with cluster link cache
+#if !defined(_PFF_PROFILE_SEEK32)
+  #define _USE_READ     1       // Enable pf_read() function
+  #define _USE_LSEEK    1       // Enable pf_lseek() function
+#endif
+//#define _LSEEK_CACHE  16      // optionally change number of cached cluster links (default 8)
+
+
+///////////
+// optionally use hardware SPI (SCK=PC5, MOSI=PC6, MISO=PC7) instead of bitbanging.
+// Then only INIT_PORT() and SPI_SD_CSN are used
+///////////
+//#define USE_SD_HW_SPI
+
+
+///////////
+// define macros required in PetitFS diskio.c and bitbang mode
+///////////
+#define	INIT_PORT()	{  \
+  pinMode(&PORT_C, 6, OUTPUT);                 /* SPI_MOSI */  \
+  pinMode(&PORT_C, 7, INPUT_PULLUP);           /* SPI_MISO */  \
+  pinMode(&PORT_C, 5, OUTPUT);                 /* SPI_SCK */  \
+  pinMode(&PORT_F, 0, OUTPUT);                 /* CSN for SD card */  \
+}
+#define SPI_MOSI   pinOutputReg(&PORT_C,pin6)  ///< SPI MOSI output
+#define SPI_MISO   pinInputReg(&PORT_C,pin7)   ///< SPI MISO input
+#define SPI_SCK    pinOutputReg(&PORT_C,pin5)  ///< SPI SCK output
+#define SPI_SD_CSN pinOutputReg(&PORT_F,pin0)  ///< CSN output for SD card selection
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif  // _CONFIG_H_
@@ -0,0 +1,111 @@
+/**********************
+  Arduino-like project with setup() & loop(). 
+  measure pf_lseek() latency of PetitFS for random access into a large file,
+  e.g. replay of a recording. Compare FAT16 reference build with FAT32 +
+  cluster link cache profile (_PFF_PROFILE_SEEK32) via 'config.h'.
+  Notes:
+    - SD cards generally use 3.3V -> check schematics
+    - copy a large file (e.g. several MB) named RECORD.BIN to SD card
+    - for code size compare the linker output (.map) of both builds
+    - pin macros are required in 'config.h'
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "main_general.h"    // board-independent main
+#include "uart1.h"           // UART1 communication
+#include "putchar.h"         // for printf()
+#include "pff.h"             // SD card with petit file system
+
+
+/*----------------------------------------------------------
+    MACROS
+----------------------------------------------------------*/
+
+// number of random seeks
+#define NUM_SEEK    100
+
+
+/*----------------------------------------------------------
+    FUNCTIONS
+----------------------------------------------------------*/
+
+//////////
+// user setup, called once after reset
+//////////
+void setup() {
+
+  // init UART1 to 115.2kBaud, 8N1, full duplex
+  UART1_begin(115200);
+
+  // use UART1 for printf() output
+  putcharAttach(UART1_write);
+
+  // wait for terminal to launch
+  delay(1000);
+  
+} // setup
+
+
+
+//////////
+// user loop, called continuously
+//////////
+void loop() {
+  
+  // for PetitFS
+  FATFS     fatfs;
+  BYTE      rc, buff[16];
+  UINT      br;
+
+  // for measurement
+  uint32_t  ofs, rnd, t, tSum, tMax;
+  uint16_t  i;
+  
+  
+  // print profile
+  #if defined(_PFF_PROFILE_SEEK32)
+    printf("\nProfile FAT32 + cluster link cache (%d entries)\n", (int) _LSEEK_CACHE);
+  #else
+    printf("\nProfile FAT16\n");
+  #endif
+
+  // mount SD card and open file
+  rc = pf_mount(&fatfs);
+  if (rc) pf_print_error(rc,1);
+  rc = pf_open("RECORD.BIN");
+  if (rc) pf_print_error(rc,1);
+  printf("file size %ldB, cluster size %ldB\n", (long) fatfs.fsize, (long) fatfs.csize * 512);
+
+  // worst case: seek from start to end of file
+  t = micros();
+  rc = pf_lseek(fatfs.fsize-1);
+  t = micros() - t;
+  if (rc) pf_print_error(rc,1);
+  printf("seek to end:    %ldus\n", (long) t);
+
+  // random seeks with short read, e.g. replay. Pseudo-random -> same sequence for both builds
+  tSum = 0;
+  tMax = 0;
+  rnd  = 1;
+  for (i=0; i<NUM_SEEK; i++) {
+    rnd = rnd * 1103515245L + 12345L;
+    ofs = rnd % fatfs.fsize;
+    t = micros();
+    rc = pf_lseek(ofs);
+    t = micros() - t;
+    if (rc) pf_print_error(rc,1);
+    tSum += t;
+    if (t > tMax)
+      tMax = t;
+    rc = pf_read(buff, sizeof(buff), &br);
+    if (rc) pf_print_error(rc,1);
+  }
+  printf("random seek:    avg %ldus, max %ldus (%d seeks)\n", (long) (tSum/NUM_SEEK), (long) tMax, (int) NUM_SEEK);
+
+  // print message
+  printf("\nTest completed.\n");
+  for (;;) ;
+
+} // loop
@@ -0,0 +1,170 @@
+#!/usr/bin/python
+
+'''
+ Host side loopback test for framed packet protocol (see Library/Base/inc/frame.h).
+ Counterpart of project General_Examples/Frame_Loopback. Measures
+   - throughput: send random frames and check echo
+   - resync: send random noise before each frame and check that the frame still passes
+ At the end, print receive statistics of STM8
+'''
+
+# required modules
+import sys
+import time
+import random
+import argparse
+import serial
+
+
+# SLIP special characters
+SLIP_END     = 0xC0
+SLIP_ESC     = 0xDB
+SLIP_ESC_END = 0xDC
+SLIP_ESC_ESC = 0xDD
+
+
+#########
+def crc16(data, crc=0xFFFF):
+  """
+   CRC16-CCITT (poly 0x1021, start 0xFFFF, MSB first). Same as frame_crc16()
+  """
+  for d in bytearray(data):
+    x = ((crc >> 8) ^ d) & 0xFF
+    x ^= x >> 4
+    crc = ((crc << 8) ^ (x << 12) ^ (x << 5) ^ x) & 0xFFFF
+  return crc
+  # end crc16()
+
+
+#########
+def encode(payload):
+  """
+   SLIP encode payload with CRC16. Same as frame_send()
+  """
+  crc = crc16(payload)
+  raw = bytearray(payload) + bytearray([crc >> 8, crc & 0xFF])
+  out = bytearray([SLIP_END])
+  for d in raw:
+    if d == SLIP_END:
+      out += bytearray([SLIP_ESC, SLIP_ESC_END])
+    elif d == SLIP_ESC:
+      out += bytearray([SLIP_ESC, SLIP_ESC_ESC])
+    else:
+      out.append(d)
+  out.append(SLIP_END)
+  return out
+  # end encode()
+
+
+#########
+class Decoder:
+  """
+   incremental SLIP decoder with CRC check. Same as frame_receiveByte()
+  """
+  def __init__(self):
+    self.buf = bytearray()
+    self.esc = False
+    self.err = False
+    self.errors = 0
+
+  def feed(self, data):
+    """ feed received bytes, return list of valid payloads """
+    frames = []
+    for d in bytearray(data):
+      if d == SLIP_END:
+        if (not self.err) and (len(self.buf) >= 2):
+          if crc16(self.buf) == 0:
+            frames.append(bytes(self.buf[:-2]))
+          else:
+            self.errors += 1
+        elif self.err or (len(self.buf) != 0):
+          self.errors += 1
+        self.buf = bytearray()
+        self.esc = False
+        self.err = False
+      elif self.err:
+        pass
+      elif d == SLIP_ESC:
+        self.esc = True
+      elif self.esc:
+        self.esc = False
+        if d == SLIP_ESC_END:
+          self.buf.append(SLIP_END)
+        elif d == SLIP_ESC_ESC:
+          self.buf.append(SLIP_ESC)
+        else:
+          self.err = True
+      else:
+        self.buf.append(d)
+    return frames
+  # end Decoder
+
+
+#########
+def transfer(port, decoder, tx, timeout):
+  """
+   send bytes and wait for one valid frame. Return payload or None on timeout
+  """
+  port.write(tx)
+  tStop = time.time() + timeout
+  while time.time() < tStop:
+    frames = decoder.feed(port.read(port.in_waiting or 1))
+    if len(frames) > 0:
+      return frames[0]
+  return None
+  # end transfer()
+
+
+##################
+# main program
+##################
+
+# commandline parameters with defaults
+parser = argparse.ArgumentParser(description="loopback test for SLIP+CRC16 frames")
+parser.add_argument("-p", "--port",    default='/dev/ttyUSB0', help="serial port")
+parser.add_argument("-b", "--baud",    default=115200, type=int, help="baudrate")
+parser.add_argument("-n", "--num",     default=1000,   type=int, help="number of frames per test")
+parser.add_argument("-s", "--size",    default=64,     type=int, help="max. payload size (FRAME_BUFFER_SIZE)")
+parser.add_argument("-z", "--noise",   default=16,     type=int, help="max. number of noise bytes before each frame")
+parser.add_argument("-t", "--timeout", default=0.5,    type=float, help="echo timeout [s]")
+args = parser.parse_args()
+
+port = serial.Serial(args.port, args.baud, timeout=0.01)
+port.reset_input_buffer()
+decoder = Decoder()
+
+# throughput: random frames incl. special characters, check echo
+numOk = 0
+numBytes = 0
+tStart = time.time()
+for i in range(args.num):
+  payload = bytes(bytearray([random.randint(0, 255) for j in range(random.randint(1, args.size))]))
+  if transfer(port, decoder, encode(payload), args.timeout) == payload:
+    numOk += 1
+    numBytes += len(payload)
+tDelta = time.time() - tStart
+print("throughput: %d/%d frames ok, %.1f kB/s payload (both directions: %.1f kB/s)" %
+  (numOk, args.num, numBytes/tDelta/1000.0, 2*numBytes/tDelta/1000.0))
+
+# resync: random noise before frame, check that frame passes
+numOk = 0
+for i in range(args.num):
+  noise = bytearray([random.randint(0, 255) for j in range(random.randint(1, args.noise))])
+  payload = bytes(bytearray([random.randint(0, 255) for j in range(random.randint(1, args.size))]))
+  if transfer(port, decoder, noise + encode(payload), args.timeout) == payload:
+    numOk += 1
+print("resync:     %d/%d frames ok after noise" % (numOk, args.num))
+
+# read STM8 statistics via empty frame
+stats = transfer(port, decoder, encode(b''), args.timeout)
+if (stats is None) or (len(stats) != 10):
+  print("statistics: no response")
+  sys.exit(1)
+stats = bytearray(stats)
+val = [(stats[2*i] << 8) | stats[2*i+1] for i in range(5)]
+print("statistics: ok=%d, CRC=%d, overflow=%d, escape=%d, dropped=%d (STM8), CRC=%d (PC)" %
+  (val[0], val[1], val[2], val[3], val[4], decoder.errors))
+
+port.close()
+
+# END OF MODULE